@@ -18,19 +18,36 @@ namespace yy {
 
 
     // 带符号整数 编码  return in < 0 ? (-in * 2 - 1) : (in * 2)
-    inline uint16_t ZigZagEncode(int16_t const& in) {
+    constexpr uint16_t ZigZagEncode(int16_t const& in) {
         return (uint16_t)((in << 1) ^ (in >> 15));
     }
-    inline uint32_t ZigZagEncode(int32_t const& in) {
+    constexpr uint32_t ZigZagEncode(int32_t const& in) {
         return (in << 1) ^ (in >> 31);
     }
-    inline uint64_t ZigZagEncode(int64_t const& in) {
+    constexpr uint64_t ZigZagEncode(int64_t const& in) {
         return (in << 1) ^ (in >> 63);
     }
 
+    // 整数 7bit 变长编码后的最大字节数
+    template<typename T>
+    constexpr size_t VarIntMaxSize_v = (sizeof(T) * 8 + 6) / 7;
+
+    // 整数 7bit 变长编码后的字节数( 带符号整数按 ZigZag 之后计算 ). 可用于 精确计算预留空间
+    template<typename T, typename = std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>>
+    constexpr size_t VarIntSize(T const& v) {
+        using UT = std::make_unsigned_t<T>;
+        UT u(v);
+        if constexpr (std::is_signed_v<T>) {
+            if constexpr (sizeof(T) <= 4) u = UT(ZigZagEncode(int32_t(v)));
+            else u = UT(ZigZagEncode(int64_t(v)));
+        }
+        return ((size_t)std::bit_width(u | 1u) * 9 + 64) >> 6;       // 即 max(1, ceil(bits / 7))
+    }
+
     // 数字字节序交换
     template<typename T>
     T BSwap(T const& i) {
+        if constexpr (sizeof(T) == 1) return i;
         T r;
 #ifdef _WIN32
         if constexpr (sizeof(T) == 2) *(uint16_t*)&r = _byteswap_ushort(*(uint16_t*)&i);
@@ -44,6 +61,173 @@ namespace yy {
         return r;
     }
 
+    // 数组字节序交换: 从 in 读 n 个 T, 交换后写到 out( 可原地, 不要求对齐 ). 每次 16 字节: SSSE3 pshufb, 或 SSE2 字交换 + 字节移位. 余下逐个 BSwap
+    template<typename T>
+    inline void BSwapArray(void const* const& in, void* const& out, size_t const& n) {
+        static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+        auto s = (uint8_t const*)in;
+        auto d = (uint8_t*)out;
+        if constexpr (sizeof(T) == 1) {
+            if (n && s != d) {
+                memmove(d, s, n);
+            }
+            return;
+        }
+        size_t i = 0;
+#if defined(YY_SSSE3) || defined(YY_SSE2)
+        constexpr size_t step = 16 / sizeof(T);
+#endif
+#if defined(YY_SSSE3)
+        __m128i m;
+        if constexpr (sizeof(T) == 2) m = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+        else if constexpr (sizeof(T) == 4) m = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+        else m = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+        for (; i + step <= n; i += step) {
+            auto x = _mm_loadu_si128((__m128i const*)(s + i * sizeof(T)));
+            _mm_storeu_si128((__m128i*)(d + i * sizeof(T)), _mm_shuffle_epi8(x, m));
+        }
+#elif defined(YY_SSE2)
+        for (; i + step <= n; i += step) {
+            auto x = _mm_loadu_si128((__m128i const*)(s + i * sizeof(T)));
+            if constexpr (sizeof(T) == 4) {
+                x = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0xB1), 0xB1);        // 交换 每 32bit 内的 两个 16bit
+            }
+            else if constexpr (sizeof(T) == 8) {
+                x = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0x1B), 0x1B);        // 反转 每 64bit 内的 四个 16bit
+            }
+            x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+            _mm_storeu_si128((__m128i*)(d + i * sizeof(T)), x);
+        }
+#endif
+        T v;
+        for (; i < n; ++i) {
+            memcpy(&v, s + i * sizeof(T), sizeof(T));
+            v = BSwap(v);
+            memcpy(d + i * sizeof(T), &v, sizeof(T));
+        }
+    }
+
+    // 返回最低位的 1 的 bit 的下标
+    inline size_t CalcTz(uint64_t const& n) {
+        assert(n);
+#ifdef _MSC_VER
+        unsigned long r = 0;
+# if defined(_WIN64) || defined(_M_X64)
+        _BitScanForward64(&r, n);
+# else
+        if (!_BitScanForward(&r, (uint32_t)n)) {
+            _BitScanForward(&r, (uint32_t)(n >> 32));
+            r += 32;
+        }
+# endif
+        return (size_t)r;
+#else
+        return (size_t)__builtin_ctzll(n);
+#endif
+    }
+
+    // 读 小尾 8 字节
+    inline uint64_t LoadLE64(uint8_t const* const& p) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+#ifdef __BIG_ENDIAN__
+        v = BSwap(v);
+#endif
+        return v;
+    }
+
+    // 写 小尾 8 字节
+    inline void StoreLE64(uint8_t* const& p, uint64_t v) {
+#ifdef __BIG_ENDIAN__
+        v = BSwap(v);
+#endif
+        memcpy(p, &v, 8);
+    }
+
+    // 将 最多 56bit 的数值 拆成 n 个 7bit 组( VarIntCompact 的逆操作 ), 除最后一组外 均加上延续位. n 为 VarIntSize
+    inline uint64_t VarIntSpread(uint64_t x, size_t const& n) {
+        static constexpr uint64_t continuations[9] = { 0, 0, 0x80u, 0x8080u, 0x808080u, 0x80808080u
+            , 0x8080808080u, 0x808080808080u, 0x80808080808080u };
+#ifdef YY_BMI2
+        x = _pdep_u64(x, 0x7f7f7f7f7f7f7f7fu);
+#else
+        x = (x & 0x000000000fffffffu) | ((x & 0x00fffffff0000000u) << 4);
+        x = (x & 0x00003fff00003fffu) | ((x & 0x0fffc0000fffc000u) << 2);
+        x = (x & 0x007f007f007f007fu) | ((x & 0x3f803f803f803f80u) << 1);
+#endif
+        return x | continuations[n];
+    }
+
+    // 取 p 开始 16 字节 的 7bit 变长整数 延续位( 每字节最高位 ) 掩码: bit k 对应 p[k]
+    inline uint32_t VarIntContinuationMask16(uint8_t const* const& p) {
+#ifdef YY_SSE2
+        return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((__m128i const*)p));
+#else
+        auto f = [](uint64_t const& v) {
+            return (uint32_t)(((v & 0x8080808080808080u) * 0x0002040810204081u) >> 56);
+        };
+        return f(LoadLE64(p)) | (f(LoadLE64(p + 8)) << 8);
+#endif
+    }
+
+    // 将 64bit 读入的 n( 1 ~ 8 ) 字节 7bit 变长整数 去掉延续位并拼接成数值
+    inline uint64_t VarIntCompact(uint64_t x, size_t const& n) {
+        auto sh = (8 - n) * 8;
+#ifdef YY_BMI2
+        return _pext_u64((x << sh) >> sh, 0x7f7f7f7f7f7f7f7fu);
+#else
+        x = ((x << sh) >> sh) & 0x7f7f7f7f7f7f7f7fu;
+        x = (x & 0x007f007f007f007fu) | ((x & 0x7f007f007f007f00u) >> 1);
+        x = (x & 0x00003fff00003fffu) | ((x & 0x3fff00003fff0000u) >> 2);
+        x = (x & 0x000000000fffffffu) | ((x & 0x0fffffff00000000u) >> 4);
+        return x;
+#endif
+    }
+
+    // 将拼接好的数值 转为 T( 带符号则 ZigZag 解码 ). 与 Data_r::ReadVarInteger 的截断行为一致
+    template<typename T>
+    inline T VarIntCast(uint64_t const& u) {
+        using UT = std::make_unsigned_t<T>;
+        if constexpr (std::is_signed_v<T>) {
+            if constexpr (sizeof(T) <= 4) return (T)ZigZagDecode(uint32_t(UT(u)));
+            else return (T)ZigZagDecode(uint64_t(UT(u)));
+        }
+        else return UT(u);
+    }
+
+    // 将 p 开始的 16 个 单字节 7bit 变长整数 展开到 tar[16]
+    template<typename T>
+    inline void VarIntExpand16(uint8_t const* const& p, T* const& tar) {
+#ifdef YY_SSE2
+        if constexpr (std::is_unsigned_v<T> && sizeof(T) >= 2) {
+            auto v = _mm_loadu_si128((__m128i const*)p);
+            auto z = _mm_setzero_si128();
+            auto lo = _mm_unpacklo_epi8(v, z), hi = _mm_unpackhi_epi8(v, z);                    // 2 x 8 x u16
+            if constexpr (sizeof(T) == 2) {
+                _mm_storeu_si128((__m128i*)tar, lo);
+                _mm_storeu_si128((__m128i*)tar + 1, hi);
+            }
+            else {
+                __m128i w[4] = { _mm_unpacklo_epi16(lo, z), _mm_unpackhi_epi16(lo, z)
+                    , _mm_unpacklo_epi16(hi, z), _mm_unpackhi_epi16(hi, z) };                       // 4 x 4 x u32
+                for (int k = 0; k < 4; ++k) {
+                    if constexpr (sizeof(T) == 4) {
+                        _mm_storeu_si128((__m128i*)tar + k, w[k]);
+                    }
+                    else {
+                        _mm_storeu_si128((__m128i*)tar + k * 2, _mm_unpacklo_epi32(w[k], z));
+                        _mm_storeu_si128((__m128i*)tar + k * 2 + 1, _mm_unpackhi_epi32(w[k], z));
+                    }
+                }
+            }
+            return;
+        }
+#endif
+        for (int k = 0; k < 16; ++k) {
+            tar[k] = VarIntCast<T>(p[k]);
+        }
+    }
+
     // 返回首个出现 1 的 bit 的下标
     inline size_t Calc2n(size_t const& n) {
         assert(n);
@@ -119,7 +303,7 @@ namespace yy {
         YY_INLINE bool operator==(Span const& o) const {
             if (&o == this) return true;
             if (len != o.len) return false;
-            return 0 == memcmp(buf, o.buf, len);
+            return !len || 0 == memcmp(buf, o.buf, len);
         }
 
         YY_INLINE bool operator!=(Span const& o) const {
@@ -292,12 +476,7 @@ namespace yy {
             assert(tar);
             if (offset + sizeof(T) * siz > len) return __LINE__;
 #ifdef __BIG_ENDIAN__
-            auto p = buf + offset;
-            T v;
-            for (size_t i = 0; i < siz; ++i) {
-                memcpy(&v, p + i * sizeof(T), sizeof(T));
-                tar[i] = BSwap(v);
-            }
+            BSwapArray<T>(buf + offset, tar, siz);
 #else
             memcpy(tar, buf + offset, sizeof(T) * siz);
 #endif
@@ -305,14 +484,60 @@ namespace yy {
             return 0;
         }
 
+        // 读 定长大尾数字 数组. 返回非 0 则读取失败
+        template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>>>
+        [[nodiscard]] YY_INLINE int ReadFixedArrayBE(T* const& tar, size_t const& siz) {
+            assert(tar);
+            if (offset + sizeof(T) * siz > len) return __LINE__;
+#ifdef __LITTLE_ENDIAN__
+            BSwapArray<T>(buf + offset, tar, siz);
+#else
+            memcpy(tar, buf + offset, sizeof(T) * siz);
+#endif
+            offset += sizeof(T) * siz;
+            return 0;
+        }
 
-        // 读 变长整数. 返回非 0 则读取失败
-        template<typename T>
+
+        // 读 变长整数. 返回非 0 则读取失败. needCheck 为 false 时不检查越界( 调用方需确保剩余长度 >= VarIntMaxSize_v<T> )
+        // 剩余 >= 8 字节时: 1 ~ 3 字节值直接判断, 更长的值 一次 64bit 读取, 由 ctz 定位结束字节 再位拼接, 无逐字节判断
+        // 超过 8 字节的值 或 临近末尾 走逐字节解码
+        template<bool needCheck = true, typename T>
         [[nodiscard]] YY_INLINE int ReadVarInteger(T &v) {
+            if (len - offset >= 8) {
+                if (buf[offset] < 0x80) {                               // 1 ~ 2 字节( 长度, 个数, typeId 等常见小数字 ) 优先
+                    v = VarIntCast<T>(buf[offset++]);
+                    return 0;
+                }
+                if (buf[offset + 1] < 0x80) {
+                    v = VarIntCast<T>((buf[offset] & 0x7Fu) | ((uint32_t)buf[offset + 1] << 7));
+                    offset += 2;
+                    return 0;
+                }
+                if constexpr (VarIntMaxSize_v<T> >= 3) {
+                    if (buf[offset + 2] < 0x80) {
+                        v = VarIntCast<T>((buf[offset] & 0x7Fu) | ((uint32_t)(buf[offset + 1] & 0x7Fu) << 7) | ((uint32_t)buf[offset + 2] << 14));
+                        offset += 3;
+                        return 0;
+                    }
+                }
+                auto x = LoadLE64(buf + offset);
+                if (auto stops = ~x & 0x8080808080808080u) {
+                    auto n = (CalcTz(stops) >> 3) + 1;
+                    if constexpr (VarIntMaxSize_v<T> < 8) {
+                        if (n > VarIntMaxSize_v<T>) return __LINE__;
+                    }
+                    v = VarIntCast<T>(VarIntCompact(x, n));
+                    offset += n;
+                    return 0;
+                }
+            }
             using UT = std::make_unsigned_t<T>;
             UT u(0);
             for (size_t shift = 0; shift < sizeof(T) * 8; shift += 7) {
-                if (offset == len) return __LINE__;
+                if constexpr (needCheck) {
+                    if (offset == len) return __LINE__;
+                }
                 auto b = (UT) buf[offset++];
                 u |= UT((b & 0x7Fu) << shift);
                 if ((b & 0x80) == 0) {
@@ -328,6 +553,60 @@ namespace yy {
             return __LINE__;
         }
 
+        // 批量读 变长整数 到 tar[siz]. 与逐个 ReadVarInteger 结果一致. 返回非 0 则读取失败
+        // 余量充足时 每次取 16 字节的延续位掩码: 全为单字节值( 小数字常见情况 ) 则整块展开, 否则按掩码切分, 每个值一次 64bit 读取 + 位拼接
+        // 跨越 16 字节块尾的值 及 末尾余量不足的部分 走常规解码
+        template<typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+        [[nodiscard]] YY_INLINE int ReadVarIntegers(T* const& tar, size_t const& siz) {
+            assert(tar || !siz);
+            size_t i = 0;
+            // 块内 值的起点 pos 最大 15, 其后 一次 64bit 读取( 或 最长 10 字节的值 ), 故需 16 + max(8, 最大长度) 字节余量
+            while (i < siz && len - offset >= 16 + std::max<size_t>(8, VarIntMaxSize_v<T>)) {
+                auto p = buf + offset;
+                auto m = VarIntContinuationMask16(p);
+                if (!m && siz - i >= 16) {
+                    VarIntExpand16(p, tar + i);
+                    i += 16;
+                    offset += 16;
+                    continue;
+                }
+                uint32_t stops = ~m & 0xFFFFu;
+                size_t pos = 0;
+                while (stops && i < siz) {
+                    auto e = CalcTz(stops);                             // 当前值 最后一个字节 的下标
+                    auto n = e + 1 - pos;
+                    if (n > VarIntMaxSize_v<T>) return __LINE__;
+                    uint64_t u;
+                    if constexpr (VarIntMaxSize_v<T> > 8) {
+                        if (n > 8) {
+                            u = VarIntCompact(LoadLE64(p + pos), 8) | (uint64_t(p[pos + 8] & 0x7Fu) << 56);
+                            if (n == 10) {
+                                u |= uint64_t(p[pos + 9]) << 63;
+                            }
+                        }
+                        else {
+                            u = VarIntCompact(LoadLE64(p + pos), n);
+                        }
+                    }
+                    else {
+                        u = VarIntCompact(LoadLE64(p + pos), n);
+                    }
+                    tar[i++] = VarIntCast<T>(u);
+                    pos = e + 1;
+                    stops &= stops - 1;
+                }
+                offset += pos;
+                if (!pos) {
+                    if (int r = ReadVarInteger<false>(tar[i])) return r;
+                    ++i;
+                }
+            }
+            for (; i < siz; ++i) {
+                if (int r = ReadVarInteger(tar[i])) return r;
+            }
+            return 0;
+        }
+
         // 读出并填充到变量. 可同时填充多个. 返回非 0 则读取失败
         template<typename ...TS>
         int Read(TS&...vs) {
@@ -346,14 +625,291 @@ namespace yy {
     /***************************************************************************************************************************/
 
 
+    // Data 内存分配器接口. Data_rw 的 allocator 为空时直接走 malloc / free
+    // 注意: allocator 的生命周期需要覆盖所有使用它的 Data. 移动 Data 时 allocator 跟随 buf 一起移动( pinned 的除外 )
+    struct DataAllocator {
+        // 为 true 表示 本分配器 是 某个 Data 派生类 自身的成员( 参考 DataChain ), 不可随 buf 移交给 别的 Data
+        // 以 Data 身份 move 时 只能复制, 且 源 保持不变
+        bool pinned = false;
+
+        virtual ~DataAllocator() = default;
+
+        // 分配一块内存. siz 为 Round2n 之后的长度( 含 reserveLen ). 失败返回空( Data 会抛 std::bad_alloc )
+        virtual void* Alloc(size_t const& siz) = 0;
+
+        // 归还 Alloc 得到的内存. siz 与 Alloc 时一致
+        virtual void Free(void* const& p, size_t const& siz) = 0;
+
+        // 扩容并保留前 usedLen 字节( 含 reserveLen ). 默认为 Alloc + memcpy + Free. 可重载以实现原地扩展 / 换页不复制
+        // 失败返回空( p 仍有效 )
+        virtual void* Realloc(void* const& p, size_t const& siz, size_t const& usedLen, size_t const& newSiz) {
+            auto newP = Alloc(newSiz);
+            if (!newP) return nullptr;
+            memcpy(newP, p, usedLen);
+            Free(p, siz);
+            return newP;
+        }
+
+        // 接管扩容( 可选, 参考 DataChain ). 返回 true 表示已处理完毕: buf len cap 可能被替换, 原数据可能已被转移走( len 清 0 )
+        // 返回 false 则走常规的 Alloc + memcpy + Free. newCap 为 Reserve 的参数( 通常为 len + 本次要写入的长度 )
+        virtual bool Grow(uint8_t*& /*buf*/, size_t& /*len*/, size_t& /*cap*/, size_t const& /*newCap*/) {
+            return false;
+        }
+    };
+
+    // 首次分配内存时的 预缺页 策略( 令虚拟内存提前对应到物理内存, 避免使用过程中缺页 )
+    enum class DataPrefaults : uint8_t {
+        None,                   // 不处理, 用到哪页才缺页. 适合 预留很大 但不一定用得完 的场景
+        Touch,                  // 每 4096 字节写 1 字节
+        Populate                // 批量填充( madvise MADV_POPULATE_WRITE ), 系统不支持则退化为 Touch
+    };
+
+    // allocator 为空的 Data 首次分配内存时使用的 预缺页 策略
+    inline DataPrefaults defaultDataPrefault = DataPrefaults::Touch;
+
+    // 按策略对 [p, p + siz) 做 预缺页 处理
+    inline void DataPrefault(void* const& p, size_t const& siz, DataPrefaults const& policy) {
+        if (policy == DataPrefaults::None || !p || !siz) return;
+#ifdef MADV_POPULATE_WRITE
+        if (policy == DataPrefaults::Populate) {
+            // 按页对齐扩展范围. 不会修改内存内容, 故首尾页被别人共用也不要紧
+            auto b = (size_t)p & ~(size_t)4095;
+            auto e = ((size_t)p + siz + 4095) & ~(size_t)4095;
+            if (madvise((void*)b, e - b, MADV_POPULATE_WRITE) == 0) return;
+        }
+#endif
+        for (size_t i = 0; i < siz; i += 4096) ((uint8_t*)p)[i] = 0;
+    }
+
+    // 大块内存分配器: 达到阈值的分配直接向系统申请按 2MB 对齐的页( linux 下申请透明大页, 减少 TLB 占用 ), 并按策略预缺页
+    // 小于阈值的走 malloc. 适合 超大快照 一类的 Data. 注意使用过程中不要修改 hugePageThreshold
+    struct DataPageAllocator : DataAllocator {
+        static constexpr size_t hugePageSize = 2 * 1024 * 1024;
+        DataPrefaults prefault = DataPrefaults::None;
+        size_t hugePageThreshold = 4 * 1024 * 1024;                 // 为 0 则总是走 malloc
+
+        // 是否直接向系统申请
+        [[nodiscard]] YY_INLINE bool IsLarge(size_t const& siz) const {
+            return hugePageThreshold && siz >= hugePageThreshold;
+        }
+
+        // 向上对齐到 hugePageSize
+        YY_INLINE static size_t RoundPages(size_t const& siz) {
+            return (siz + hugePageSize - 1) & ~(hugePageSize - 1);
+        }
+
+        void* Alloc(size_t const& siz) override {
+            if (!IsLarge(siz)) {
+                auto p = malloc(siz);
+                DataPrefault(p, siz, prefault);
+                return p;
+            }
+            auto len = RoundPages(siz);
+#ifdef _WIN32
+            auto p = VirtualAlloc(nullptr, len, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+            if (!p) return nullptr;
+#else
+            auto p = MapAligned(len);
+            if (!p) return nullptr;
+#   ifdef MADV_HUGEPAGE
+            madvise(p, len, MADV_HUGEPAGE);
+#   endif
+#endif
+            DataPrefault(p, len, prefault);
+            return p;
+        }
+
+#ifndef _WIN32
+        // 申请 len 字节 按 2MB 对齐 的匿名映射. 失败返回空
+        YY_INLINE static uint8_t* MapAligned(size_t const& len) {
+            // 多申请一个大页的长度, 以便裁剪出 2MB 对齐的区域
+            auto raw = (uint8_t*)mmap(nullptr, len + hugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (raw == (uint8_t*)MAP_FAILED) return nullptr;
+            auto p = (uint8_t*)(((size_t)raw + hugePageSize - 1) & ~(hugePageSize - 1));
+            if (p > raw) {
+                munmap(raw, p - raw);
+            }
+            if (auto tail = (raw + len + hugePageSize) - (p + len)) {
+                munmap(p + len, tail);
+            }
+            return p;
+        }
+#endif
+
+        void Free(void* const& p, size_t const& siz) override {
+            if (!IsLarge(siz)) {
+                free(p);
+                return;
+            }
+#ifdef _WIN32
+            VirtualFree(p, 0, MEM_RELEASE);
+#else
+            munmap(p, RoundPages(siz));
+#endif
+        }
+
+        // 新旧都是小块走 realloc. 新旧都是大块的话 linux 下走 mremap: 只改页表映射, 不复制数据
+        // mremap 先尝试 原地扩展, 不行 再把页 挪到 新申请的 2MB 对齐区域( MREMAP_FIXED ), 以保持 大页 所需的对齐
+        void* Realloc(void* const& p, size_t const& siz, size_t const& usedLen, size_t const& newSiz) override {
+            if (!IsLarge(siz) && !IsLarge(newSiz)) {
+                auto newP = (uint8_t*)realloc(p, newSiz);
+                if (!newP) return nullptr;
+                DataPrefault(newP + siz, newSiz - siz, prefault);
+                return newP;
+            }
+#ifdef __linux__
+            if (IsLarge(siz)) {
+                auto len = RoundPages(siz);
+                auto newLen = RoundPages(newSiz);
+                auto newP = (uint8_t*)mremap(p, len, newLen, 0);
+                if (newP == (uint8_t*)MAP_FAILED) {
+                    if (auto tar = MapAligned(newLen)) {
+                        newP = (uint8_t*)mremap(p, len, newLen, MREMAP_MAYMOVE | MREMAP_FIXED, tar);
+                        if (newP == (uint8_t*)MAP_FAILED) {
+                            munmap(tar, newLen);
+                        }
+                    }
+                }
+                if (newP != (uint8_t*)MAP_FAILED) {
+#   ifdef MADV_HUGEPAGE
+                    madvise(newP, newLen, MADV_HUGEPAGE);
+#   endif
+                    DataPrefault(newP + len, newLen - len, prefault);
+                    return newP;
+                }
+            }
+#endif
+            return this->DataAllocator::Realloc(p, siz, usedLen, newSiz);
+        }
+    };
+
+    // 按 Round2n 容量分级复用内存块的池. 非线程安全, 通常用 ThreadLocal() 取当前线程的实例
+    // 注意: 使用它的 Data 需要在同一线程释放
+    struct DataPool : DataAllocator {
+        std::array<std::vector<void*>, sizeof(size_t) * 8> blocks;  // 下标为 Calc2n(siz)
+        size_t maxBlocksPerClass = 64;                              // 每一级最多缓存多少块, 超出直接 free
+
+        DataPool() = default;
+        DataPool(DataPool const&) = delete;
+        DataPool& operator=(DataPool const&) = delete;
+
+        ~DataPool() override {
+            Trim();
+        }
+
+        void* Alloc(size_t const& siz) override {
+            auto& bs = blocks[Calc2n(siz)];
+            if (bs.empty()) return malloc(siz);
+            auto p = bs.back();
+            bs.pop_back();
+            return p;
+        }
+
+        void Free(void* const& p, size_t const& siz) override {
+            auto& bs = blocks[Calc2n(siz)];
+            if (bs.size() < maxBlocksPerClass) {
+                bs.push_back(p);
+            }
+            else {
+                free(p);
+            }
+        }
+
+        // 释放所有缓存的内存块
+        void Trim() {
+            for (auto& bs : blocks) {
+                for (auto& p : bs) {
+                    free(p);
+                }
+                bs.clear();
+            }
+        }
+
+        // 当前线程的池
+        static DataPool& ThreadLocal() {
+            thread_local DataPool pool;
+            return pool;
+        }
+    };
+
+    // 线性( bump )分配器: 从大块内存中顺序切分, Free 不做任何事, 每帧调用一次 Reset 整体回收
+    // 注意: Reset 之后, 之前从这里分配内存的 Data 不可再读写( 析构 / Clear 是安全的 )
+    //       向系统申请内存块 失败时 抛 std::bad_alloc( 与 new 失败行为一致 ), 已有的块 不受影响
+    struct DataArena : DataAllocator {
+        std::vector<std::pair<uint8_t*, size_t>> chunks;            // 内存块 + 块长. 最后一个为当前块
+        size_t chunkLen = 0;                                        // 当前块已用长度
+
+        explicit DataArena(size_t const& cap = 1024 * 1024) {
+            chunks.emplace_back(NewChunk(cap), cap);
+        }
+        DataArena(DataArena const&) = delete;
+        DataArena& operator=(DataArena const&) = delete;
+
+        ~DataArena() override {
+            for (auto& c : chunks) {
+                free(c.first);
+            }
+        }
+
+        void* Alloc(size_t const& siz) override {
+            chunkLen = (chunkLen + 15) & ~(size_t)15;
+            if (chunkLen + siz > chunks.back().second) {
+                auto cap = std::max(chunks.back().second * 2, siz);
+                chunks.reserve(chunks.size() + 1);
+                chunks.emplace_back(NewChunk(cap), cap);
+                chunkLen = 0;
+            }
+            auto p = chunks.back().first + chunkLen;
+            chunkLen += siz;
+            return p;
+        }
+
+        void Free(void* const& /*p*/, size_t const& /*siz*/) override {
+        }
+
+        // 整体回收. 如果本帧用到了多个块, 则合并成一个足够大的块, 下一帧就不再需要追加
+        void Reset() {
+            if (chunks.size() > 1) {
+                size_t total = 0;
+                for (auto& c : chunks) {
+                    total += c.second;
+                }
+                total = Round2n(total);
+                auto p = NewChunk(total);
+                for (auto& c : chunks) {
+                    free(c.first);
+                }
+                chunks.clear();
+                chunks.emplace_back(p, total);
+            }
+            chunkLen = 0;
+        }
+
+        YY_INLINE static uint8_t* NewChunk(size_t const& cap) {
+            auto p = (uint8_t*)malloc(cap);
+            if (!p) throw std::bad_alloc();
+            return p;
+        }
+    };
+
+
     // 基础二进制数据容器 附带基础 流式读写 功能，可配置预留长度方便有些操作在 buf 最头上放东西
     template<size_t reserveLen = 0>
     struct Data_rw : Data_r {
         size_t cap;
+        DataAllocator* allocator;   // 为空则使用 malloc / free
 
         // buf = len = offset = cap = 0
         Data_rw()
-            : cap(0) {
+            : cap(0), allocator(nullptr) {
+        }
+
+        // 指定分配器, 可顺便预分配空间
+        explicit Data_rw(DataAllocator& allocator, size_t const& cap = 0)
+            : cap(0), allocator(&allocator) {
+            if (cap) {
+                Reserve<false>(cap);
+            }
         }
 
         // unsafe: 直接设置成员数值, 常用于有把握的"借壳" 读写( 不会造成 Reserve 操作的 ), 最后记得 Reset 还原
@@ -364,28 +920,28 @@ namespace yy {
 
         // 预分配空间
         explicit Data_rw(size_t const &cap)
-                : cap(cap) {
+                : cap(cap), allocator(nullptr) {
             assert(cap);
             auto siz = Round2n(reserveLen + cap);
-            buf = (new uint8_t[siz]) + reserveLen;
+            buf = AllocBlock(siz) + reserveLen;
             this->cap = siz - reserveLen;
         }
 
         // 复制( offset = 0 )
         Data_rw(Span const& s)
-            : cap(0) {
+            : cap(0), allocator(nullptr) {
             WriteBuf(s.buf, s.len);
         }
 
         // 复制( offset = 0 )
         Data_rw(void const *const &ptr, size_t const &siz)
-            : cap(0) {
+            : cap(0), allocator(nullptr) {
             WriteBuf(ptr, siz);
         }
 
-        // 复制( offset = 0 )
+        // 复制( offset = 0 ). 不复制 allocator
         Data_rw(Data_rw const &o)
-            : cap(0) {
+            : Data_r(), cap(0), allocator(nullptr) {
             operator=(o);
         }
 
@@ -399,22 +955,46 @@ namespace yy {
         YY_INLINE Data_rw& operator=(T const& o) {
             if (this == &o) return *this;
             Clear();
-            WriteBuf(o.buf, o.len);
+            if (o.len) {
+                WriteBuf(o.buf, o.len);
+            }
             return *this;
         }
 
-        // 将 o 的数据挪过来
-        Data_rw(Data_rw &&o) noexcept {
+        // 将 o 的数据挪过来( o 使用 pinned allocator 的话只能复制 )
+        // 复制 可能因 分配内存 失败 抛 std::bad_alloc, 故 不标 noexcept
+        Data_rw(Data_rw &&o) {
+            if (o.IsPinned()) {
+                memset((void*)this, 0, sizeof(Data_rw));
+                WriteBuf(o.buf, o.len);
+                offset = o.offset;
+                if (!o.IsPinned()) {
+                    o.len = 0;
+                    o.offset = 0;
+                }
+                return;
+            }
             memcpy((void*)this, &o, sizeof(Data_rw));
             memset((void*)&o, 0, sizeof(Data_rw));
         }
 
-        // 交换数据
-        YY_INLINE Data_rw &operator=(Data_rw &&o) noexcept {
+        // 交换数据( 任意一方使用 pinned allocator 的话只能复制, 可能抛 std::bad_alloc )
+        YY_INLINE Data_rw &operator=(Data_rw &&o) {
+            if (IsPinned() || o.IsPinned()) {
+                if (this == &o) return *this;
+                Clear();
+                WriteBuf(o.buf, o.len);
+                offset = o.offset;
+                if (!o.IsPinned()) {
+                    o.Clear();
+                }
+                return *this;
+            }
             std::swap(buf, o.buf);
             std::swap(len, o.len);
             std::swap(cap, o.cap);
             std::swap(offset, o.offset);
+            std::swap(allocator, o.allocator);
             return *this;
         }
 
@@ -431,10 +1011,25 @@ namespace yy {
         template<bool CheckCap = true>
         YY_NOINLINE void Reserve(size_t const &newCap) {
             if (CheckCap && newCap <= cap) return;
+            if (allocator && allocator->Grow(buf, len, cap, newCap)) return;
 
             auto siz = Round2n(reserveLen + newCap);
+
+            // 数据量过半时走 realloc: 有机会原地扩展, 大块内存则由系统换页( glibc 下为 mremap ), 都不需要复制数据
+            // 数据量少的话 realloc 可能会复制整个旧块, 还不如下面只复制 len 字节
+            // 预缺页 只针对 首次分配, 这里不做( 新增部分 会在写入时 缺页 )
+            if (len && len >= cap / 2) {
+                auto p = allocator
+                    ? (uint8_t*)allocator->Realloc(buf - reserveLen, cap + reserveLen, reserveLen + len, siz)
+                    : (uint8_t*)realloc(buf - reserveLen, siz);
+                if (!p) throw std::bad_alloc();                     // 原 buf 仍有效
+                buf = p + reserveLen;
+                cap = siz - reserveLen;
+                return;
+            }
+
             //auto newBuf = (new uint8_t[siz]) + reserveLen;
-            auto newBuf = ((uint8_t*)malloc(siz)) + reserveLen;
+            auto newBuf = AllocBlock(siz) + reserveLen;
             if (len) {
                 memcpy(newBuf, buf, len);
             }
@@ -442,11 +1037,11 @@ namespace yy {
             // 这里判断 cap 不判断 buf, 是因为 gcc 优化会导致 if 失效, 无论如何都会执行 free
             if (cap) {
                 //delete[](buf - reserveLen);
-                free(buf - reserveLen);
+                FreeBlock(buf - reserveLen, cap + reserveLen);
             }
-            else {
-                // let virtual memory -> physics
-                for(size_t i = 0; i < newCap; i += 4096) (newBuf - reserveLen)[i] = 0;
+            else if (!allocator) {
+                // let virtual memory -> physics( 有 allocator 的话由 allocator 自己决定 )
+                DataPrefault(newBuf - reserveLen, newCap, defaultDataPrefault);
             }
             buf = newBuf;
             cap = siz - reserveLen;
@@ -570,12 +1165,24 @@ namespace yy {
                 }
             }
 #ifdef __BIG_ENDIAN__
-            auto p = buf + len;
-            T v;
-            for (size_t i = 0; i < siz; ++i) {
-                v = BSwap(ptr[i]);
-                memcpy(p + i * sizeof(T), &v, sizeof(T));
+            BSwapArray<T>(ptr, buf + len, siz);
+#else
+            memcpy(buf + len, ptr, sizeof(T) * siz);
+#endif
+            len += sizeof(T) * siz;
+        }
+
+        // 追加写入 float / double / integer ( 定长 Big Endian ) 数组
+        template<bool needReserve = true, typename T, typename = std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>>>
+        YY_INLINE void WriteFixedArrayBE(T const* const& ptr, size_t const& siz) {
+            assert(ptr);
+            if constexpr (needReserve) {
+                if (len + sizeof(T) * siz > cap) {
+                    Reserve<false>(len + sizeof(T) * siz);
+                }
             }
+#ifdef __LITTLE_ENDIAN__
+            BSwapArray<T>(ptr, buf + len, siz);
 #else
             memcpy(buf + len, ptr, sizeof(T) * siz);
 #endif
@@ -592,10 +1199,21 @@ namespace yy {
                 else u = ZigZagEncode(int64_t(v));
             }
             if constexpr (needReserve) {
-                if (len + sizeof(T) + 2 > cap) {
-                    Reserve<false>(len + sizeof(T) + 2);
+                if (len + VarIntMaxSize_v<T> > cap) {
+                    Reserve<false>(len + VarIntMaxSize_v<T>);
                 }
             }
+            if (u < 0x80) {
+                buf[len++] = uint8_t(u);
+                return;
+            }
+            // 空间充足 且 不超过 8 字节: 算出长度, 拆分后 一次 8 字节写入
+            if (cap - len >= 8 && (sizeof(T) < 8 || !(uint64_t(u) >> 56))) {
+                auto n = VarIntSize(u);
+                StoreLE64(buf + len, VarIntSpread(u, n));
+                len += n;
+                return;
+            }
             while (u >= 1 << 7) {
                 buf[len++] = uint8_t((u & 0x7fu) | 0x80u);
                 u = UT(u >> 7);
@@ -604,6 +1222,24 @@ namespace yy {
         }
 
 
+        // 批量追加写入整数( 7bit 变长格式 ). 与逐个 WriteVarInteger 结果一致. 按块预留空间, 块内免检查
+        template<bool needReserve = true, typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+        YY_INLINE void WriteVarIntegers(T const* const& ptr, size_t const& siz) {
+            assert(ptr || !siz);
+            constexpr size_t blockSiz = 256;                            // 避免一次按最大长度预留 siz 个值 导致过度分配
+            for (size_t i = 0; i < siz; i += blockSiz) {
+                auto n = std::min(blockSiz, siz - i);
+                if constexpr (needReserve) {
+                    if (len + n * VarIntMaxSize_v<T> > cap) {
+                        Reserve<false>(len + n * VarIntMaxSize_v<T>);
+                    }
+                }
+                for (auto p = ptr + i, e = p + n; p != e; ++p) {
+                    WriteVarInteger<false>(*p);
+                }
+            }
+        }
+
         // 跳过指定长度字节数不写。返回起始 len
         template<bool needReserve = true>
         YY_INLINE size_t WriteJump(size_t const &siz) {
@@ -634,22 +1270,161 @@ namespace yy {
             Clear(true);
         }
 
+        // 判断 allocator 是否为 某个派生类 自身的成员( 参考 DataAllocator::pinned, SmallData ). 不可移交
+        [[nodiscard]] YY_INLINE bool IsPinned() const {
+            return allocator && allocator->pinned;
+        }
+
         // len 清 0, 可彻底释放 buf
         YY_INLINE void Clear(bool const &freeBuf = false) {
             if (freeBuf && cap) {
                 //delete[](buf - reserveLen);
-                free(buf - reserveLen);
+                FreeBlock(buf - reserveLen, cap + reserveLen);
                 buf = nullptr;
                 cap = 0;
             }
             len = 0;
             offset = 0;
         }
+
+    protected:
+        // 分配 / 释放 内存块( 含 reserveLen ). siz 为 Round2n 之后的长度
+        YY_INLINE uint8_t* AllocBlock(size_t const& siz) const {
+            auto p = (uint8_t*)(allocator ? allocator->Alloc(siz) : malloc(siz));
+            if (!p) throw std::bad_alloc();                         // 与 new 失败行为一致
+            return p;
+        }
+
+        YY_INLINE void FreeBlock(uint8_t* const& p, size_t const& siz) const {
+            if (allocator) {
+                allocator->Free(p, siz);
+            }
+            else {
+                free(p);
+            }
+        }
     };
 
     using Data = Data_rw<0>;
     using DataView = Data_r;
 
+    // 前 inlineCap 字节使用内嵌空间的 Data. 短消息不会触发内存分配, 超出后自动转为堆内存
+    // 可当作 Data 使用( 传 Data& 参数, 序列化 等 ). 但需注意以 Data 身份 move 出去时只能复制
+    // 内嵌空间 由 自身的 pinned 分配器 管理( 按地址 认出 内嵌空间, 不释放 ), 故 allocator 不可替换. 堆内存 改走别的分配器 请设置 Heap()
+    template<size_t inlineCap>
+    struct SmallData : Data {
+        static_assert(inlineCap > 0);
+
+        // 内嵌空间 分配器: 内嵌空间 不释放, 其他内存块 交给 heap( 为空则 malloc / free )
+        struct Inline : DataAllocator {
+            uint8_t* inlineBuf = nullptr;
+            DataAllocator* heap = nullptr;
+
+            void* Alloc(size_t const& siz) override {
+                return heap ? heap->Alloc(siz) : malloc(siz);
+            }
+
+            void Free(void* const& p, size_t const& siz) override {
+                if (p == inlineBuf) return;
+                if (heap) {
+                    heap->Free(p, siz);
+                }
+                else {
+                    free(p);
+                }
+            }
+
+            void* Realloc(void* const& p, size_t const& siz, size_t const& usedLen, size_t const& newSiz) override {
+                if (p == inlineBuf) return this->DataAllocator::Realloc(p, siz, usedLen, newSiz);
+                return heap ? heap->Realloc(p, siz, usedLen, newSiz) : realloc(p, newSiz);
+            }
+        } inl;
+        uint8_t inlineBuf[inlineCap];
+
+        SmallData() {
+            inl.pinned = true;
+            inl.inlineBuf = inlineBuf;
+            allocator = &inl;
+            buf = inlineBuf;
+            cap = inlineCap;
+        }
+
+        // 复制( offset = 0 )
+        SmallData(Span const& s)
+            : SmallData() {
+            WriteBuf(s.buf, s.len);
+        }
+
+        // 复制( offset = 0 )
+        SmallData(void const* const& ptr, size_t const& siz)
+            : SmallData() {
+            WriteBuf(ptr, siz);
+        }
+
+        // 复制( offset = 0 )
+        SmallData(SmallData const& o)
+            : SmallData() {
+            WriteBuf(o.buf, o.len);
+        }
+
+        SmallData(SmallData&& o) noexcept
+            : SmallData() {
+            operator=(std::move(o));
+        }
+
+        // 先于 inl 析构 释放 堆内存
+        ~SmallData() {
+            this->Data::Clear(true);
+        }
+
+        // 复制( offset = 0 )
+        YY_INLINE SmallData& operator=(SmallData const& o) {
+            if (this == &o) return *this;
+            Clear();
+            WriteBuf(o.buf, o.len);
+            return *this;
+        }
+
+        // o 使用堆内存时挪过来( 连同 heap ), 否则复制到 内嵌空间( 容量相同, 不会分配内存 )
+        YY_INLINE SmallData& operator=(SmallData&& o) noexcept {
+            if (this == &o) return *this;
+            if (o.buf == o.inlineBuf) {
+                Clear();
+                WriteBuf<false>(o.buf, o.len);
+                offset = o.offset;
+                o.Clear();
+            }
+            else {
+                Clear(true);
+                inl.heap = o.inl.heap;
+                buf = o.buf;
+                len = o.len;
+                offset = o.offset;
+                cap = o.cap;
+                o.buf = o.inlineBuf;
+                o.cap = inlineCap;
+                o.len = 0;
+                o.offset = 0;
+            }
+            return *this;
+        }
+
+        // 超出内嵌空间后 使用的分配器( 为空则 malloc / free ). 只能在 尚未使用堆内存 时 设置
+        YY_INLINE void Heap(DataAllocator* const& heap) {
+            assert(buf == inlineBuf);
+            inl.heap = heap;
+        }
+
+        // len 清 0, 可彻底释放 buf. 释放后回到使用内嵌空间的状态
+        YY_INLINE void Clear(bool const& freeBuf = false) {
+            this->Data::Clear(freeBuf);
+            if (!cap) {
+                buf = inlineBuf;
+                cap = inlineCap;
+            }
+        }
+    };
+
     /************************************************************************************/
     // Data 序列化 / 反序列化 基础适配模板
     template<typename T, typename ENABLED = void>
@@ -685,6 +1460,20 @@ namespace yy {
 
 
 
+    // 容器序列化时 可整块 读写 的元素类型: 1 字节整数( 不含 bool ), 浮点( 定长小尾 ). 另: IsRawLayout 结构体 整块 memcpy
+    template<typename T>
+    constexpr bool IsFixedArrayElement_v = (std::is_integral_v<T> && sizeof(T) == 1 && !std::is_same_v<T, bool>) || std::is_floating_point_v<T>;
+
+    // IsRawLayout 的使用限制检查
+    template<typename T>
+    constexpr bool RawLayoutCheck() {
+        static_assert(std::is_trivially_copyable_v<T>);
+#ifdef __BIG_ENDIAN__
+        static_assert(!IsRawLayout_v<T>, "IsRawLayout requires little endian host");
+#endif
+        return true;
+    }
+
     /**********************************************************************************************************************/
     // 为 Data.Read / Write 提供简单序列化功能( 1字节整数, float/double  memcpy,   别的整数 包括长度 变长. std::string/Data 写 长度 + 内容
     // 这里只针对 “基础类型”
@@ -708,6 +1497,19 @@ namespace yy {
         }
     };
 
+    // 适配 标记了 IsRawLayout 的 POD 结构体( 直接读写内存映像 )
+    template<typename T>
+    struct DataFuncs<T, std::enable_if_t<IsRawLayout_v<T>>> {
+        static_assert(RawLayoutCheck<T>());
+        template<bool needReserve = true>
+        static inline void Write(Data& d, T const& in) {
+            d.WriteBuf<needReserve>(&in, sizeof(T));
+        }
+        static inline int Read(Data_r& d, T& out) {
+            return d.ReadBuf(&out, sizeof(T));
+        }
+    };
+
     // 适配 Span ( do not write len )
     template<typename T>
     struct DataFuncs<T, std::enable_if_t<std::is_same_v<Span, std::decay_t<T>>>> {
@@ -759,8 +1561,14 @@ namespace yy {
     struct DataFuncs<T, std::enable_if_t<std::is_same_v<std::string_view, std::decay_t<T>>>> {
         template<bool needReserve = true>
         static inline void Write(Data& d, T const& in) {
-            d.WriteVarInteger<needReserve>(in.size());
-            d.WriteBuf<needReserve>((char*)in.data(), in.size());
+            if constexpr (needReserve) {
+                auto siz = d.len + VarIntSize(in.size()) + in.size();
+                if (siz > d.cap) {
+                    d.Reserve<false>(siz);
+                }
+            }
+            d.WriteVarInteger<false>(in.size());
+            d.WriteBuf<false>((char*)in.data(), in.size());
         }
         static inline int Read(Data_r& d, T& out) {
             size_t siz = 0;
@@ -915,19 +1723,15 @@ namespace yy {
                 d.WriteVarInteger<needReserve>(in.size());
                 if (in.empty()) return;
             }
-            if constexpr (sizeof(T) == 1 || std::is_floating_point_v<T>) {
+            using E = typename T::value_type;
+            if constexpr (IsFixedArrayElement_v<E>) {
                 d.WriteFixedArray<needReserve>(in.data(), in.size());
             }
-            else if constexpr (std::is_integral_v<typename T::value_type>) {
-                if constexpr (needReserve) {
-                    auto cap = in.size() * (sizeof(T) + 1);
-                    if (d.cap < cap) {
-                        d.Reserve<false>(cap);
-                    }
-                }
-                for (auto&& o : in) {
-                    d.WriteVarInteger<false>(o);
-                }
+            else if constexpr (IsRawLayout_v<E>) {
+                d.WriteBuf<needReserve>(in.data(), in.size() * sizeof(E));
+            }
+            else if constexpr (std::is_integral_v<E>) {
+                d.WriteVarIntegers<needReserve>(in.data(), in.size());
             }
             else {
                 for (auto&& o : in) {
@@ -947,9 +1751,16 @@ namespace yy {
                 siz = out.size();
             }
             auto buf = out.data();
-            if constexpr (sizeof(T) == 1 || std::is_floating_point_v<T>) {
+            using E = typename T::value_type;
+            if constexpr (IsFixedArrayElement_v<E>) {
                 if (int r = d.ReadFixedArray(buf, siz)) return r;
             }
+            else if constexpr (IsRawLayout_v<E>) {
+                if (int r = d.ReadBuf(buf, siz * sizeof(E))) return r;
+            }
+            else if constexpr (std::is_integral_v<E> && sizeof(E) >= 2) {
+                if (int r = d.ReadVarIntegers(buf, siz)) return r;
+            }
             else {
                 for (size_t i = 0; i < siz; ++i) {
                     if (int r = d.Read(buf[i])) return r;
@@ -959,6 +1770,314 @@ namespace yy {
         }
     };
 
+    /**********************************************************************************************************************/
+    // 整数容器 的可选编码. 默认格式不变, 需显式以 EncodedVector<T, 编码> 作为 字段 / 容器 类型. 均为 变长长度 + 数据:
+    // Varint       逐个 7bit 变长( 与 std::vector<T> 的默认格式相同 )
+    // DeltaZigZag  与前一个值的差( 首个值与 0 比 ) ZigZag 后 7bit 变长. 适合 单调递增 / 小幅波动 的序列( 时间戳, 自增 id )
+    // ForBitPack   每 128 个值一块: 块内最小值( 7bit 变长 ) + 位宽 b( 1 字节 ) + 16 * b 字节 紧密打包的 (v - min)
+    //              打包为 128bit 纵向交错( 32bit 4 路 / 64bit 2 路 ), 解码时一次 SSE2 移位得到 4 / 2 个值. 不足 128 的尾部 逐个 7bit 变长
+    // FixedLE      定长小尾 原样( 解码即 memcpy )
+    /*
+        struct Foo {
+            yy::EncodedVector<int64_t, yy::IntEncodings::DeltaZigZag> times;
+            yy::EncodedVector<uint32_t, yy::IntEncodings::ForBitPack> ids;
+        };
+    */
+    enum class IntEncodings : uint8_t {
+        Varint,
+        DeltaZigZag,
+        ForBitPack,
+        FixedLE
+    };
+
+    template<typename T, IntEncodings E>
+    struct EncodedVector : std::vector<T> {
+        static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>);
+        static constexpr IntEncodings encoding = E;
+        using std::vector<T>::vector;
+        EncodedVector() = default;
+        EncodedVector(std::vector<T> const& o) : std::vector<T>(o) {}
+        EncodedVector(std::vector<T>&& o) noexcept : std::vector<T>(std::move(o)) {}
+    };
+
+    template<typename T>
+    struct IsEncodedVector : std::false_type {
+    };
+    template<typename T, IntEncodings E>
+    struct IsEncodedVector<EncodedVector<T, E>> : std::true_type {
+    };
+    template<typename T>
+    constexpr bool IsEncodedVector_v = IsEncodedVector<std::decay_t<T>>::value;
+
+    // 无符号域( 回绕运算 ) 差值 ZigZag 编码 in[n] 到 out[n]. prev 为前一个值, 结束时更新为 in 的最后一个值
+    template<typename U>
+    inline void DeltaZigZagEncode(U const* in, U* out, size_t const& n, U& prev) {
+        static_assert(std::is_unsigned_v<U>);
+        for (size_t i = 0; i < n; ++i) {
+            U d = U(in[i] - prev);
+            prev = in[i];
+            out[i] = U(U(d << 1) ^ U(0 - (d >> (sizeof(U) * 8 - 1))));
+        }
+    }
+
+    // DeltaZigZagEncode 的逆运算( 原地 ). 32 / 64bit 每次 16 字节: ZigZag 解码 + 寄存器内 前缀和 + 加上一块的末值
+    template<typename U>
+    inline void DeltaZigZagDecode(U* p, size_t const& n, U& prev) {
+        static_assert(std::is_unsigned_v<U>);
+        size_t i = 0;
+#ifdef YY_SSE2
+        if constexpr (sizeof(U) == 4) {
+            auto one = _mm_set1_epi32(1);
+            auto base = _mm_set1_epi32((int)prev);
+            for (; i + 4 <= n; i += 4) {
+                auto x = _mm_loadu_si128((__m128i const*)(p + i));
+                auto d = _mm_xor_si128(_mm_srli_epi32(x, 1), _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(x, one)));
+                d = _mm_add_epi32(d, _mm_slli_si128(d, 4));
+                d = _mm_add_epi32(d, _mm_slli_si128(d, 8));
+                d = _mm_add_epi32(d, base);
+                _mm_storeu_si128((__m128i*)(p + i), d);
+                base = _mm_shuffle_epi32(d, 0xFF);
+            }
+        }
+        else if constexpr (sizeof(U) == 8) {
+            auto one = _mm_set1_epi64x(1);
+            auto base = _mm_set1_epi64x((long long)prev);
+            for (; i + 2 <= n; i += 2) {
+                auto x = _mm_loadu_si128((__m128i const*)(p + i));
+                auto d = _mm_xor_si128(_mm_srli_epi64(x, 1), _mm_sub_epi64(_mm_setzero_si128(), _mm_and_si128(x, one)));
+                d = _mm_add_epi64(d, _mm_slli_si128(d, 8));
+                d = _mm_add_epi64(d, base);
+                _mm_storeu_si128((__m128i*)(p + i), d);
+                base = _mm_shuffle_epi32(d, 0xEE);
+            }
+        }
+        if (i) {
+            prev = p[i - 1];
+        }
+#endif
+        for (; i < n; ++i) {
+            auto x = p[i];
+            prev = U(prev + U(U(x >> 1) ^ U(0 - (x & 1))));
+            p[i] = prev;
+        }
+    }
+
+    // ForBitPack 的打包单元: 64bit 元素用 uint64_t, 其他用 uint32_t. 一块 128 个值 = 16 / sizeof(W) 路 * (sizeof(W) * 8) 个
+    template<typename T>
+    using ForBitPackWord_t = std::conditional_t<sizeof(T) == 8, uint64_t, uint32_t>;
+
+    // 把 128 个 b 位的值 纵向交错打包到 out[16 * b]: 第 i 个值 属于 第 i % 路数 路, 各路 第 k 个字 位于 out 的第 k * 路数 + 路 个字
+    template<typename W>
+    inline void ForBitPackEncode(W const* in, int const& b, uint8_t* out) {
+        constexpr int L = 16 / sizeof(W), B = sizeof(W) * 8;
+        assert(b > 0 && b <= B);
+        for (int l = 0; l < L; ++l) {
+            W acc = 0;
+            int bits = 0, k = 0;
+            for (int j = 0; j < B; ++j) {
+                auto x = in[j * L + l];
+                acc |= x << bits;
+                bits += b;
+                if (bits >= B) {
+                    bits -= B;
+#ifdef __BIG_ENDIAN__
+                    acc = BSwap(acc);
+#endif
+                    memcpy(out + (k++ * L + l) * sizeof(W), &acc, sizeof(W));
+                    acc = bits ? W(x >> (b - bits)) : W(0);
+                }
+            }
+        }
+    }
+
+    // ForBitPackEncode 的逆运算, 同时加上 base( 块内最小值 ). in 需有 16 * b 字节
+    template<typename W>
+    inline void ForBitPackDecode(uint8_t const* in, int const& b, W const& base, W* out) {
+        constexpr int L = 16 / sizeof(W), B = sizeof(W) * 8;
+        assert(b > 0 && b <= B);
+#if defined(YY_SSE2) && !defined(__BIG_ENDIAN__)
+        auto p = (__m128i const*)in;
+        auto cur = _mm_loadu_si128(p);
+        __m128i mask, vbase;
+        if constexpr (B == 32) {
+            mask = _mm_set1_epi32(int(b == B ? ~W(0) : (W(1) << b) - 1));
+            vbase = _mm_set1_epi32((int)base);
+        }
+        else {
+            mask = _mm_set1_epi64x((long long)(b == B ? ~W(0) : (W(1) << b) - 1));
+            vbase = _mm_set1_epi64x((long long)base);
+        }
+        int bits = 0;
+        for (int j = 0; j < B; ++j) {
+            __m128i x;
+            if constexpr (B == 32) x = _mm_srl_epi32(cur, _mm_cvtsi32_si128(bits));
+            else x = _mm_srl_epi64(cur, _mm_cvtsi32_si128(bits));
+            bits += b;
+            if (bits >= B) {
+                bits -= B;
+                if (j + 1 < B || bits) {
+                    cur = _mm_loadu_si128(++p);
+                    if (bits) {
+                        if constexpr (B == 32) x = _mm_or_si128(x, _mm_sll_epi32(cur, _mm_cvtsi32_si128(b - bits)));
+                        else x = _mm_or_si128(x, _mm_sll_epi64(cur, _mm_cvtsi32_si128(b - bits)));
+                    }
+                }
+            }
+            x = _mm_and_si128(x, mask);
+            if constexpr (B == 32) x = _mm_add_epi32(x, vbase);
+            else x = _mm_add_epi64(x, vbase);
+            _mm_storeu_si128((__m128i*)(out + j * L), x);
+        }
+#else
+        W mask = b == B ? ~W(0) : (W(1) << b) - 1;
+        for (int l = 0; l < L; ++l) {
+            W cur, x;
+            int bits = 0, k = 0;
+            memcpy(&cur, in + l * sizeof(W), sizeof(W));
+#ifdef __BIG_ENDIAN__
+            cur = BSwap(cur);
+#endif
+            for (int j = 0; j < B; ++j) {
+                x = cur >> bits;
+                bits += b;
+                if (bits >= B) {
+                    bits -= B;
+                    if (j + 1 < B || bits) {
+                        memcpy(&cur, in + (++k * L + l) * sizeof(W), sizeof(W));
+#ifdef __BIG_ENDIAN__
+                        cur = BSwap(cur);
+#endif
+                        if (bits) {
+                            x |= cur << (b - bits);
+                        }
+                    }
+                }
+                out[j * L + l] = W((x & mask) + base);
+            }
+        }
+#endif
+    }
+
+    // 适配 EncodedVector
+    template<typename T>
+    struct DataFuncs<T, std::enable_if_t<IsEncodedVector_v<T>>> {
+        using E = typename T::value_type;
+        using U = std::make_unsigned_t<E>;
+        using W = ForBitPackWord_t<E>;
+        static constexpr size_t blockSiz = 128;
+
+        template<bool needReserve = true>
+        static inline void Write(Data& d, T const& in) {
+            if constexpr (T::encoding == IntEncodings::Varint) {
+                DataFuncs<std::vector<E>>::template Write<needReserve>(d, in);
+            }
+            else if constexpr (T::encoding == IntEncodings::FixedLE) {
+                d.WriteVarInteger<needReserve>(in.size());
+                if (in.empty()) return;
+                d.WriteFixedArray<needReserve>(in.data(), in.size());
+            }
+            else if constexpr (T::encoding == IntEncodings::DeltaZigZag) {
+                d.WriteVarInteger<needReserve>(in.size());
+                U tmp[256], prev = 0;
+                for (size_t i = 0; i < in.size(); i += std::size(tmp)) {
+                    auto n = std::min(std::size(tmp), in.size() - i);
+                    DeltaZigZagEncode((U const*)in.data() + i, tmp, n, prev);
+                    d.WriteVarIntegers<needReserve>((U const*)tmp, n);
+                }
+            }
+            else {
+                static_assert(T::encoding == IntEncodings::ForBitPack);
+                d.WriteVarInteger<needReserve>(in.size());
+                W tmp[blockSiz];
+                size_t i = 0;
+                for (; i + blockSiz <= in.size(); i += blockSiz) {
+                    auto p = in.data() + i;
+                    auto mi = *std::min_element(p, p + blockSiz);
+                    W bs = 0;
+                    for (size_t j = 0; j < blockSiz; ++j) {
+                        tmp[j] = W(U(U(p[j]) - U(mi)));
+                        bs |= tmp[j];
+                    }
+                    auto b = (int)std::bit_width(bs);
+                    if constexpr (needReserve) {
+                        auto cap = d.len + VarIntMaxSize_v<E> + 1 + 16 * b;
+                        if (d.cap < cap) {
+                            d.Reserve<false>(cap);
+                        }
+                    }
+                    d.WriteVarInteger<false>(mi);
+                    d.buf[d.len++] = uint8_t(b);
+                    if (b) {
+                        ForBitPackEncode(tmp, b, d.buf + d.len);
+                        d.len += 16 * b;
+                    }
+                }
+                d.WriteVarIntegers<needReserve>(in.data() + i, in.size() - i);
+            }
+        }
+
+        static inline int Read(Data_r& d, T& out) {
+            if constexpr (T::encoding == IntEncodings::Varint) {
+                return DataFuncs<std::vector<E>>::Read(d, out);
+            }
+            else {
+                size_t siz = 0;
+                if (int r = d.Read(siz)) return r;
+                if constexpr (T::encoding == IntEncodings::ForBitPack) {
+                    if (d.offset + siz / blockSiz * 2 + siz % blockSiz > d.len) return __LINE__;     // 每块至少 2 字节
+                }
+                else {
+                    if (d.offset + siz > d.len) return __LINE__;
+                }
+                out.resize(siz);
+                if (siz == 0) return 0;
+                return ReadValues(d, out.data(), siz);
+            }
+        }
+
+        // 读 siz 个值到 p( 不含 Varint 编码 )
+        static inline int ReadValues(Data_r& d, E* const& p, size_t const& siz) {
+            if constexpr (T::encoding == IntEncodings::FixedLE) {
+                return d.ReadFixedArray(p, siz);
+            }
+            else if constexpr (T::encoding == IntEncodings::DeltaZigZag) {
+                if (int r = d.ReadVarIntegers((U*)p, siz)) return r;
+                U prev = 0;
+                DeltaZigZagDecode((U*)p, siz, prev);
+                return 0;
+            }
+            else {
+                static_assert(T::encoding == IntEncodings::ForBitPack);
+                size_t i = 0;
+                for (; i + blockSiz <= siz; i += blockSiz) {
+                    E mi;
+                    uint8_t b;
+                    if (int r = d.ReadVarInteger(mi)) return r;
+                    if (int r = d.ReadFixed(b)) return r;
+                    if (b > sizeof(E) * 8) return __LINE__;
+                    auto q = p + i;
+                    if (!b) {
+                        std::fill(q, q + blockSiz, mi);
+                        continue;
+                    }
+                    if (d.offset + 16 * b > d.len) return __LINE__;
+                    if constexpr (sizeof(E) == sizeof(W)) {
+                        ForBitPackDecode(d.buf + d.offset, b, W(U(mi)), (W*)q);
+                    }
+                    else {
+                        W tmp[blockSiz];
+                        ForBitPackDecode(d.buf + d.offset, b, W(U(mi)), tmp);
+                        for (size_t j = 0; j < blockSiz; ++j) {
+                            q[j] = E(U(tmp[j]));
+                        }
+                    }
+                    d.offset += 16 * b;
+                }
+                return d.ReadVarIntegers(p + i, siz - i);
+            }
+        }
+    };
+
     // 适配 std::set, unordered_set
     template<typename T>
     struct DataFuncs<T, std::enable_if_t< IsSetSeries_v<T>/* && IsBaseDataType_v<T>*/>> {
@@ -966,9 +2085,9 @@ namespace yy {
         static inline void Write(Data& d, T const& in) {
             d.WriteVarInteger<needReserve>(in.size());
             if (in.empty()) return;
-            if constexpr (std::is_integral_v<typename T::value_type>) {
+            if constexpr (std::is_integral_v<typename T::value_type> && sizeof(typename T::value_type) >= 2) {
                 if constexpr (needReserve) {
-                    auto cap = in.size() * (sizeof(T) + 1);
+                    auto cap = d.len + in.size() * VarIntMaxSize_v<typename T::value_type>;      // 按元素最大变长长度 预留
                     if (d.cap < cap) {
                         d.Reserve<false>(cap);
                     }
@@ -989,8 +2108,10 @@ namespace yy {
             if (d.offset + siz > d.len) return __LINE__;
             out.clear();
             if (siz == 0) return 0;
+            typename T::value_type o;
             for (size_t i = 0; i < siz; ++i) {
-                if (int r = Read_(d, out.emplace())) return r;
+                if (int r = d.Read(o)) return r;
+                out.insert(std::move(o));
             }
             return 0;
         }
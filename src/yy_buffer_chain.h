@@ -0,0 +1,149 @@
+﻿#pragma once
+#include "yy_buffer.h"
+
+namespace yy {
+
+    // 分段输出缓冲区: 由若干内存块串起来, 当前块写满就封存并换新块, 已写入的数据不会再被复制( 没有 Reserve 翻倍 memcpy )
+    // 本身就是 Data, 可直接用于 Write* / DataFuncs / object_handler::WriteTo. 可导出 iovec 数组直接 writev / sendmsg, 无需合并
+    // 注意: 只支持顺序追加写入. 不可使用 WriteJump 返回的位置, Resize, WriteXxxAt 等回填操作( 数据可能已被封存到前面的块 )
+    //       不可 move. 以 Data 身份 move( 切片, 或 经 Data& 交换 ) 时 只复制 当前块, 需要全部数据 请用 ToData
+    /*
+        DataChain dc(65536);
+        om.WriteTo(dc, root);
+        std::vector<iovec> iovs(dc.SpansCount());
+        dc.FillIovecs(iovs.data(), iovs.size());
+        writev(fd, iovs.data(), (int)iovs.size());
+    */
+    struct DataChain : Data {
+        // 扩容接管: 封存当前块, 换一个新块
+        struct Blocks : DataAllocator {
+            size_t blockSize;
+            std::vector<Span> spans;                                // 已封存的块( buf 为 malloc 所得, len 为数据长度 )
+
+            void* Alloc(size_t const& siz) override {
+                return malloc(siz);
+            }
+
+            void Free(void* const& p, size_t const& /*siz*/) override {
+                free(p);
+            }
+
+            // 新块 分配失败 抛 std::bad_alloc( 当前块 不变 )
+            bool Grow(uint8_t*& buf, size_t& len, size_t& cap, size_t const& newCap) override {
+                auto need = newCap > len ? newCap - len : 1;
+                if (len && spans.size() == spans.capacity()) {
+                    spans.reserve(spans.size() * 2 + 8);            // 先扩 spans, 新块 分配成功后 不会再抛
+                }
+                auto siz = std::max(blockSize, Round2n(need));
+                auto p = (uint8_t*)malloc(siz);
+                if (!p) throw std::bad_alloc();
+                if (len) {
+                    spans.emplace_back(buf, len);
+                }
+                else if (cap) {
+                    free(buf);
+                }
+                buf = p;
+                cap = siz;
+                len = 0;
+                return true;
+            }
+
+            void Clear() {
+                for (auto& s : spans) {
+                    free(s.buf);
+                }
+                spans.clear();
+            }
+        } blocks;
+
+        // blockSize: 每块的最小长度( 单次写入超过它则按 Round2n 分配一块更大的 )
+        explicit DataChain(size_t const& blockSize = 65536) {
+            assert(blockSize);
+            blocks.blockSize = blockSize;
+            blocks.pinned = true;
+            allocator = &blocks;
+        }
+
+        DataChain(DataChain const&) = delete;
+        DataChain& operator=(DataChain const&) = delete;
+
+        ~DataChain() {
+            Clear(true);
+        }
+
+        // 清空所有数据( 可彻底释放当前块 ). 已封存的块总是会被释放
+        YY_INLINE void Clear(bool const& freeBuf = false) {
+            blocks.Clear();
+            this->Data::Clear(freeBuf);
+        }
+
+        // 所有块的数据总长
+        [[nodiscard]] YY_INLINE size_t TotalLen() const {
+            size_t n = len;
+            for (auto& s : blocks.spans) {
+                n += s.len;
+            }
+            return n;
+        }
+
+        // 数据段个数( 含当前块 )
+        [[nodiscard]] YY_INLINE size_t SpansCount() const {
+            return blocks.spans.size() + (len ? 1 : 0);
+        }
+
+        // 按顺序遍历所有数据段( 含当前块 ). f(Span const&)
+        template<typename F>
+        YY_INLINE void ForeachSpan(F&& f) const {
+            for (auto& s : blocks.spans) {
+                f(s);
+            }
+            if (len) {
+                f(Span(buf, len));
+            }
+        }
+
+        // 合并成一个连续的 Data( 主要用于调试或对接只接受连续内存的接口 )
+        [[nodiscard]] Data ToData() const {
+            Data d(TotalLen() + 1);
+            ForeachSpan([&](Span const& s) {
+                d.WriteBuf<false>(s.buf, s.len);
+            });
+            return d;
+        }
+
+#ifdef _WIN32
+        // 从第 skip 段开始填充 WSABUF 数组( 用于 WSASend ), 返回填充个数
+        YY_INLINE size_t FillWSABufs(WSABUF* const& tar, size_t const& siz, size_t skip = 0) const {
+            size_t n = 0;
+            ForeachSpan([&](Span const& s) {
+                if (skip) {
+                    --skip;
+                }
+                else if (n < siz) {
+                    tar[n].buf = (CHAR*)s.buf;
+                    tar[n].len = (ULONG)s.len;
+                    ++n;
+                }
+            });
+            return n;
+        }
+#else
+        // 从第 skip 段开始填充 iovec 数组( 用于 writev / sendmsg ), 返回填充个数
+        YY_INLINE size_t FillIovecs(iovec* const& tar, size_t const& siz, size_t skip = 0) const {
+            size_t n = 0;
+            ForeachSpan([&](Span const& s) {
+                if (skip) {
+                    --skip;
+                }
+                else if (n < siz) {
+                    tar[n].iov_base = s.buf;
+                    tar[n].iov_len = s.len;
+                    ++n;
+                }
+            });
+            return n;
+        }
+#endif
+    };
+}
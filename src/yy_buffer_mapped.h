@@ -0,0 +1,301 @@
+﻿#pragma once
+#include "yy_buffer.h"
+
+namespace yy {
+
+    // 只读映射整个文件, 作为 Data_r 使用( 零复制解码. 按需经由 page cache 读入, 不必先把整个文件读进内存 )
+    // 注意: 映射期间 文件不可被截短, 否则访问越界部分会触发 SIGBUS
+    /*
+        MappedData md;
+        if (int r = md.Open("snapshot.bin")) return r;
+        md.Advise(true);
+        if (int r = om.ReadFrom(md, root)) return r;
+    */
+    struct MappedData : Data_r {
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+#else
+        int fd = -1;
+#endif
+
+        MappedData() = default;
+        MappedData(MappedData const&) = delete;
+        MappedData& operator=(MappedData const&) = delete;
+
+        MappedData(MappedData&& o) noexcept {
+            operator=(std::move(o));
+        }
+
+        MappedData& operator=(MappedData&& o) noexcept {
+            std::swap(buf, o.buf);
+            std::swap(len, o.len);
+            std::swap(offset, o.offset);
+#ifdef _WIN32
+            std::swap(file, o.file);
+            std::swap(mapping, o.mapping);
+#else
+            std::swap(fd, o.fd);
+#endif
+            return *this;
+        }
+
+        ~MappedData() {
+            Close();
+        }
+
+        // 打开并映射整个文件( 空文件不映射, len 为 0 ). 返回非 0 表示失败
+        [[nodiscard]] int Open(char const* const& path) {
+            Close();
+#ifdef _WIN32
+            file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE) return __LINE__;
+            LARGE_INTEGER siz;
+            if (!GetFileSizeEx(file, &siz)) {
+                Close();
+                return __LINE__;
+            }
+            if (!siz.QuadPart) return 0;
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!mapping) {
+                Close();
+                return __LINE__;
+            }
+            auto p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (!p) {
+                Close();
+                return __LINE__;
+            }
+            Reset(p, (size_t)siz.QuadPart);
+#else
+            fd = open(path, O_RDONLY | O_CLOEXEC);
+            if (fd == -1) return __LINE__;
+            struct stat st;
+            if (fstat(fd, &st)) {
+                Close();
+                return __LINE__;
+            }
+            if (!st.st_size) return 0;
+            auto p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (p == MAP_FAILED) {
+                Close();
+                return __LINE__;
+            }
+            Reset(p, (size_t)st.st_size);
+#endif
+            return 0;
+        }
+
+        // 访问模式提示: sequential 为 true 则加大预读( 整体解码 ), 否则关闭预读( 随机访问 )
+        YY_INLINE void Advise(bool const& sequential) const {
+#ifndef _WIN32
+            if (len) {
+                madvise(buf, len, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+            }
+#endif
+        }
+
+        // 解除映射并关闭文件
+        void Close() {
+#ifdef _WIN32
+            if (buf) {
+                UnmapViewOfFile(buf);
+            }
+            if (mapping) {
+                CloseHandle(mapping);
+                mapping = nullptr;
+            }
+            if (file != INVALID_HANDLE_VALUE) {
+                CloseHandle(file);
+                file = INVALID_HANDLE_VALUE;
+            }
+#else
+            if (buf) {
+                munmap(buf, len);
+            }
+            if (fd != -1) {
+                close(fd);
+                fd = -1;
+            }
+#endif
+            Reset(nullptr, 0);
+        }
+    };
+
+    // 可写的文件映射, 作为 Data 使用. 容量不足时 扩大文件( ftruncate ) 并重新映射, Close 时按实际写入长度截短文件
+    // 扩容时 已写入的数据留在 page cache 中, 不发生 memcpy( linux 下为 mremap, 其他平台为 解除映射 + 重新映射 )
+    // 注意: 扩容可能改变 buf 地址. 文件扩大 或 映射 失败时抛 std::bad_alloc( 与 new 失败行为一致 )
+    //       不可 move. 以 Data 身份 move( 切片, 或 经 Data& 交换 ) 时 只复制 数据, 文件 保持不变
+    /*
+        MappedData_rw md;
+        if (int r = md.Open("snapshot.bin", true)) return r;
+        om.WriteTo(md, root);
+        if (int r = md.Close()) return r;
+    */
+    struct MappedData_rw : Data {
+        // 扩容接管: 扩大文件并重新映射
+        struct File : DataAllocator {
+#ifdef _WIN32
+            HANDLE file = INVALID_HANDLE_VALUE;
+            HANDLE mapping = nullptr;
+#else
+            int fd = -1;
+#endif
+
+            // 不会被调用( 扩容全部由 Grow 接管 )
+            void* Alloc(size_t const& /*siz*/) override {
+                assert(false);
+                return nullptr;
+            }
+
+            // 解除映射
+            void Free(void* const& p, size_t const& siz) override {
+#ifdef _WIN32
+                UnmapViewOfFile(p);
+                CloseHandle(mapping);
+                mapping = nullptr;
+#else
+                munmap(p, siz);
+#endif
+            }
+
+            // 映射文件的前 siz 字节. 返回空表示失败
+            void* Map(size_t const& siz) {
+#ifdef _WIN32
+                mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, (DWORD)((uint64_t)siz >> 32), (DWORD)siz, nullptr);
+                if (!mapping) return nullptr;
+                auto p = MapViewOfFile(mapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, siz);
+                if (!p) {
+                    CloseHandle(mapping);
+                    mapping = nullptr;
+                }
+                return p;
+#else
+                auto p = mmap(nullptr, siz, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                return p == MAP_FAILED ? nullptr : p;
+#endif
+            }
+
+            bool Grow(uint8_t*& buf, size_t& /*len*/, size_t& cap, size_t const& newCap) override {
+                auto siz = std::max(Round2n(newCap), (size_t)4096);
+                void* p = nullptr;
+#ifdef _WIN32
+                if (cap) {
+                    Free(buf, cap);                                 // CreateFileMapping 时会自动扩大文件
+                }
+                p = Map(siz);
+#else
+                if (ftruncate(fd, (off_t)siz)) throw std::bad_alloc();
+#   ifdef __linux__
+                if (cap) {
+                    p = mremap(buf, cap, siz, MREMAP_MAYMOVE);
+                    if (p == MAP_FAILED) {
+                        p = nullptr;
+                    }
+                }
+                else {
+                    p = Map(siz);
+                }
+#   else
+                if (cap) {
+                    Free(buf, cap);
+                }
+                p = Map(siz);
+#   endif
+#endif
+                if (!p) throw std::bad_alloc();
+                buf = (uint8_t*)p;
+                cap = siz;
+                return true;
+            }
+        } file;
+
+        MappedData_rw() {
+            file.pinned = true;
+            allocator = &file;
+        }
+
+        MappedData_rw(MappedData_rw const&) = delete;
+        MappedData_rw& operator=(MappedData_rw const&) = delete;
+
+        ~MappedData_rw() {
+            (void)Close();
+        }
+
+        // 打开或创建文件. truncate 为 false 则映射已有内容( len 为文件长度 ), 可继续追加或原地修改. 返回非 0 表示失败
+        [[nodiscard]] int Open(char const* const& path, bool const& truncate = false) {
+            if (int r = Close()) return r;
+            size_t siz = 0;
+#ifdef _WIN32
+            file.file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr
+                , truncate ? CREATE_ALWAYS : OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file.file == INVALID_HANDLE_VALUE) return __LINE__;
+            LARGE_INTEGER fs;
+            if (!GetFileSizeEx(file.file, &fs)) {
+                (void)Close();
+                return __LINE__;
+            }
+            siz = (size_t)fs.QuadPart;
+#else
+            file.fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0), 0644);
+            if (file.fd == -1) return __LINE__;
+            struct stat st;
+            if (fstat(file.fd, &st)) {
+                (void)Close();
+                return __LINE__;
+            }
+            siz = (size_t)st.st_size;
+#endif
+            if (siz) {
+                auto p = file.Map(siz);
+                if (!p) {
+                    (void)Close();
+                    return __LINE__;
+                }
+                buf = (uint8_t*)p;
+                len = siz;
+                cap = siz;
+            }
+            return 0;
+        }
+
+        // 将已写入的数据刷到磁盘( 同步 ). 返回非 0 表示失败
+        [[nodiscard]] int Flush() const {
+            if (!len) return 0;
+#ifdef _WIN32
+            if (!FlushViewOfFile(buf, len)) return __LINE__;
+            if (!FlushFileBuffers(file.file)) return __LINE__;
+#else
+            if (msync(buf, len, MS_SYNC)) return __LINE__;
+#endif
+            return 0;
+        }
+
+        // 解除映射, 按 len 截短文件( 去掉扩容时多出的部分 ) 并关闭. 返回非 0 表示截短失败
+        int Close() {
+            int r = 0;
+            auto siz = len;
+            this->Data::Clear(true);
+#ifdef _WIN32
+            if (file.file != INVALID_HANDLE_VALUE) {
+                LARGE_INTEGER pos;
+                pos.QuadPart = (LONGLONG)siz;
+                if (!SetFilePointerEx(file.file, pos, nullptr, FILE_BEGIN) || !SetEndOfFile(file.file)) {
+                    r = __LINE__;
+                }
+                CloseHandle(file.file);
+                file.file = INVALID_HANDLE_VALUE;
+            }
+#else
+            if (file.fd != -1) {
+                if (ftruncate(file.fd, (off_t)siz)) {
+                    r = __LINE__;
+                }
+                close(file.fd);
+                file.fd = -1;
+            }
+#endif
+            return r;
+        }
+    };
+}
@@ -0,0 +1,207 @@
+﻿#pragma once
+#include "yy_buffer.h"
+
+namespace yy {
+
+    // 环形接收缓冲区, 主要用于收包拆包. 消费数据只移动读位置( O(1) ), 不像 Data::RemoveFront 那样 memmove 剩余数据
+    // 容量为 2^n. 可读区域可能在尾部回绕, 故提供 连续视图( LeftSpan ) 以及 跨越回绕点的 分段视图( LeftSpans )
+    /*
+        典型用法:
+        Span ss[2];
+        ring.Reserve(ring.Len() + 4096);
+        ring.GetWriteSpans(ss);
+        auto n = recv(fd, ss[0].buf, ss[0].len, 0);
+        ring.Commit(n);
+        while (ring.Len() >= 4) {
+            uint32_t pkgLen;
+            (void)ring.ReadFixedAt(0, pkgLen);
+            if (ring.Len() < 4 + pkgLen) break;
+            auto dr = ring.LeftData_r(4 + pkgLen, tmp);     // 未跨越回绕点时不复制
+            dr.offset = 4;
+            ... handle dr ...
+            ring.RemoveFront(4 + pkgLen);
+        }
+    */
+    struct DataRing {
+        uint8_t* buf = nullptr;
+        size_t cap = 0;                 // 2^n
+        size_t head = 0;                // 读位置( 未取模, 只增不减 )
+        size_t tail = 0;                // 写位置( 未取模, 只增不减 )
+
+        DataRing() = default;
+        DataRing(DataRing const&) = delete;
+        DataRing& operator=(DataRing const&) = delete;
+
+        // 预分配空间
+        explicit DataRing(size_t const& cap) {
+            Reserve(cap);
+        }
+
+        DataRing(DataRing&& o) noexcept {
+            memcpy((void*)this, &o, sizeof(DataRing));
+            memset((void*)&o, 0, sizeof(DataRing));
+        }
+
+        DataRing& operator=(DataRing&& o) noexcept {
+            std::swap(buf, o.buf);
+            std::swap(cap, o.cap);
+            std::swap(head, o.head);
+            std::swap(tail, o.tail);
+            return *this;
+        }
+
+        ~DataRing() {
+            if (cap) {
+                free(buf);
+            }
+        }
+
+        // 可读数据长度
+        [[nodiscard]] YY_INLINE size_t Len() const {
+            return tail - head;
+        }
+
+        // 剩余可写长度
+        [[nodiscard]] YY_INLINE size_t FreeLen() const {
+            return cap - (tail - head);
+        }
+
+        // 确保容量足够. 扩容时会把可读数据整理到新 buf 的头部. 分配失败 抛 std::bad_alloc( 原数据 不变 )
+        YY_NOINLINE void Reserve(size_t const& newCap) {
+            if (newCap <= cap) return;
+            auto siz = Round2n(newCap);
+            auto newBuf = (uint8_t*)malloc(siz);
+            if (!newBuf) throw std::bad_alloc();
+            auto len = Len();
+            if (len) {
+                (void)ReadBufAt(0, newBuf, len);
+            }
+            if (cap) {
+                free(buf);
+            }
+            buf = newBuf;
+            cap = siz;
+            head = 0;
+            tail = len;
+        }
+
+        // 清空数据( 可彻底释放 buf )
+        YY_INLINE void Clear(bool const& freeBuf = false) {
+            if (freeBuf && cap) {
+                free(buf);
+                buf = nullptr;
+                cap = 0;
+            }
+            head = 0;
+            tail = 0;
+        }
+
+        /***************************************************************************************************************************/
+
+        // 填充可写区域( 最多两段 ), 返回段数. 写入后调用 Commit 提交实际写入长度. 适用于 recv / readv
+        YY_INLINE size_t GetWriteSpans(Span(&ss)[2]) const {
+            auto freeLen = FreeLen();
+            if (!freeLen) return 0;
+            auto mask = cap - 1;
+            auto idx = tail & mask;
+            auto firstLen = std::min(freeLen, cap - idx);
+            ss[0].Reset(buf + idx, firstLen);
+            if (firstLen == freeLen) return 1;
+            ss[1].Reset(buf, freeLen - firstLen);
+            return 2;
+        }
+
+        // 提交写入长度( 配合 GetWriteSpans )
+        YY_INLINE void Commit(size_t const& siz) {
+            assert(siz <= FreeLen());
+            tail += siz;
+        }
+
+        // 追加写入一段 buf( 空间不足会扩容 )
+        YY_INLINE void WriteBuf(void const* const& ptr, size_t const& siz) {
+            if (!siz) return;
+            if (Len() + siz > cap) {
+                Reserve(Len() + siz);
+            }
+            auto mask = cap - 1;
+            auto idx = tail & mask;
+            auto firstLen = std::min(siz, cap - idx);
+            memcpy(buf + idx, ptr, firstLen);
+            if (firstLen < siz) {
+                memcpy(buf, (uint8_t*)ptr + firstLen, siz - firstLen);
+            }
+            tail += siz;
+        }
+
+        /***************************************************************************************************************************/
+
+        // 从读位置开始的 连续 可读区域( 遇到回绕点截止 )
+        [[nodiscard]] YY_INLINE Span LeftSpan() const {
+            if (head == tail) return {};
+            auto idx = head & (cap - 1);
+            return Span(buf + idx, std::min(Len(), cap - idx));
+        }
+
+        // 从读位置开始的 连续 可读区域( 遇到回绕点截止 )
+        [[nodiscard]] YY_INLINE Data_r LeftData_r() const {
+            return Data_r(LeftSpan());
+        }
+
+        // 返回从读位置开始的 siz 字节 的连续视图. 跨越回绕点时才会复制到 tmp. 需确保 siz <= Len()
+        [[nodiscard]] YY_INLINE Data_r LeftData_r(size_t const& siz, Data& tmp) const {
+            assert(siz <= Len());
+            auto idx = head & (cap - 1);
+            if (idx + siz <= cap) return Data_r(buf + idx, siz);
+            tmp.Clear();
+            tmp.Resize(siz);
+            (void)ReadBufAt(0, tmp.buf, siz);
+            return Data_r(tmp.buf, siz);
+        }
+
+        // 填充所有可读区域( 最多两段, 跨越回绕点时为两段 ), 返回段数. 适用于 writev 或分段解析
+        YY_INLINE size_t LeftSpans(Span(&ss)[2]) const {
+            auto len = Len();
+            if (!len) return 0;
+            auto idx = head & (cap - 1);
+            auto firstLen = std::min(len, cap - idx);
+            ss[0].Reset(buf + idx, firstLen);
+            if (firstLen == len) return 1;
+            ss[1].Reset(buf, len - firstLen);
+            return 2;
+        }
+
+        // 从 读位置 + idx 处 复制 siz 字节到 tar( 可跨越回绕点 ). 不改变读位置. 返回非 0 则读取失败
+        [[nodiscard]] YY_INLINE int ReadBufAt(size_t const& idx, void* const& tar, size_t const& siz) const {
+            assert(tar);
+            if (idx + siz > Len()) return __LINE__;
+            if (!siz) return 0;
+            auto i = (head + idx) & (cap - 1);
+            auto firstLen = std::min(siz, cap - i);
+            memcpy(tar, buf + i, firstLen);
+            if (firstLen < siz) {
+                memcpy((uint8_t*)tar + firstLen, buf, siz - firstLen);
+            }
+            return 0;
+        }
+
+        // 从 读位置 + idx 处 读 定长小尾数字( 可跨越回绕点 ). 常用于读包头. 返回非 0 则读取失败
+        template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>>>
+        [[nodiscard]] YY_INLINE int ReadFixedAt(size_t const& idx, T& v) const {
+            if (int r = ReadBufAt(idx, &v, sizeof(T))) return r;
+#ifdef __BIG_ENDIAN__
+            v = BSwap(v);
+#endif
+            return 0;
+        }
+
+        // 从头部移除指定长度数据( 只移动读位置 )
+        YY_INLINE void RemoveFront(size_t const& siz) {
+            assert(siz <= Len());
+            head += siz;
+            if (head == tail) {
+                head = 0;
+                tail = 0;
+            }
+        }
+    };
+}
@@ -0,0 +1,124 @@
+﻿#pragma once
+#include "yy_buffer.h"
+#include <cerrno>
+
+namespace yy {
+
+    // 流式输出缓冲区: 固定大小的暂存区, 写满就把数据交给 sink( 回调 / FILE* / 文件描述符 ) 并清空复用. 序列化全程只占 暂存区 大小的内存
+    // 本身就是 Data, 可直接用于 Write* / DataFuncs / object_handler::WriteTo, 送出的字节 与 写入一个普通 Data 完全相同
+    // 单次写入( 或预留 ) 超过暂存区时 临时换一块够大的, 下次送出后 缩回原大小
+    // 注意: 只支持顺序追加写入. 不可使用 WriteJump 返回的位置, Resize, WriteXxxAt 等回填操作( 数据可能已被送出 )
+    //       不可用 WriteToExact( 会按总长一次预留 ). 写完需调用 Flush 送出剩余数据( 析构时不会自动送出 )
+    //       不可 move. 以 Data 身份 move( 切片, 或 经 Data& 交换 ) 时 只复制 暂存区中 未送出的数据, 不会送出
+    /*
+        DataStream ds(fileno(f), 1 << 20);
+        om.WriteTo(ds, world);
+        if (int r = ds.Flush()) ... 出错
+    */
+    struct DataStream : Data {
+        // 送出 [buf, buf + len). 返回非 0 表示出错( 之后的数据 不再送出, 见 Error() )
+        using Sink = std::function<int(uint8_t const* buf, size_t len)>;
+
+        // 扩容接管: 送出当前暂存区的数据, 清空复用
+        struct Stage : DataAllocator {
+            Sink sink;
+            size_t stageSize;
+            size_t sentLen = 0;                                     // 已送出的字节数
+            int error = 0;                                          // sink 返回的首个错误
+
+            void* Alloc(size_t const& siz) override {
+                return malloc(siz);
+            }
+
+            void Free(void* const& p, size_t const& /*siz*/) override {
+                free(p);
+            }
+
+            bool Grow(uint8_t*& buf, size_t& len, size_t& cap, size_t const& newCap) override {
+                auto need = newCap > len ? newCap - len : 1;
+                if (len) {
+                    Send(buf, len);
+                    len = 0;
+                }
+                auto siz = std::max(stageSize, Round2n(need));
+                if (need > cap || cap > siz) {
+                    auto p = (uint8_t*)malloc(siz);
+                    if (!p) throw std::bad_alloc();                 // 原 暂存区 仍有效( 数据已送出 )
+                    if (cap) {
+                        free(buf);
+                    }
+                    buf = p;
+                    cap = siz;
+                }
+                return true;
+            }
+
+            void Send(uint8_t const* const& p, size_t const& n) {
+                if (!error) {
+                    error = sink(p, n);
+                }
+                sentLen += n;
+            }
+        } stage;
+
+        // stageSize: 暂存区长度
+        DataStream(Sink sink, size_t const& stageSize = 1024 * 1024) {
+            assert(sink && stageSize);
+            stage.sink = std::move(sink);
+            stage.stageSize = stageSize;
+            stage.pinned = true;
+            allocator = &stage;
+        }
+
+        // 写入 FILE*( 不负责关闭 )
+        explicit DataStream(FILE* const& f, size_t const& stageSize = 1024 * 1024)
+            : DataStream([f](uint8_t const* buf, size_t len) {
+                return fwrite(buf, 1, len, f) == len ? 0 : __LINE__;
+            }, stageSize) {
+        }
+
+#ifndef _WIN32
+        // 写入 文件描述符( 文件 / socket / pipe. 不负责关闭 ). 阻塞写 直到全部写完
+        explicit DataStream(int const& fd, size_t const& stageSize = 1024 * 1024)
+            : DataStream([fd](uint8_t const* buf, size_t len) {
+                while (len) {
+                    auto n = ::write(fd, buf, len);
+                    if (n < 0) {
+                        if (errno == EINTR) continue;
+                        return errno ? errno : __LINE__;
+                    }
+                    buf += n;
+                    len -= (size_t)n;
+                }
+                return 0;
+            }, stageSize) {
+        }
+#endif
+
+        DataStream(DataStream const&) = delete;
+        DataStream& operator=(DataStream const&) = delete;
+
+        ~DataStream() {
+            Clear(true);                                            // 需在 stage 析构前 归还暂存区
+        }
+
+        // 送出暂存区中的剩余数据. 返回 sink 的首个错误( 0 表示全部送出成功 )
+        YY_INLINE int Flush() {
+            if (len) {
+                stage.Send(buf, len);
+                len = 0;
+            }
+            return stage.error;
+        }
+
+        // sink 的首个错误
+        [[nodiscard]] YY_INLINE int Error() const {
+            return stage.error;
+        }
+
+        // 已写入的总长( 已送出 + 暂存区中 )
+        [[nodiscard]] YY_INLINE size_t TotalLen() const {
+            return stage.sentLen + len;
+        }
+    };
+}
@@ -34,6 +34,8 @@
 #endif
 #include <algorithm>
 #include <cmath>
+#include <bit>                  // std::bit_width
+#include <atomic>               // std::atomic_ref
 
 #ifdef _WIN32
 #	define NOMINMAX
@@ -48,6 +50,10 @@
 #	include <Windows.h>
 #else
 #	include <unistd.h>          // for usleep
+#	include <sys/uio.h>         // iovec
+#	include <sys/mman.h>        // mmap madvise
+#	include <sys/stat.h>        // fstat
+#	include <fcntl.h>           // open
 #endif
 
 #ifndef _WIN32
@@ -100,6 +106,24 @@ using namespace std::chrono_literals;
 #    define YY_ARCH_64
 #endif
 
+// 定义 YY_NO_SIMD 则 不用 SSE2 / SSSE3 / BMI2, 全部走 标量 实现( 用于 测试 标量 路径 )
+#ifndef YY_NO_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define YY_SSE2
+#    include <emmintrin.h>
+#endif
+
+#if defined(__SSSE3__) || (defined(_MSC_VER) && defined(__AVX__))
+#    define YY_SSSE3
+#    include <tmmintrin.h>
+#endif
+
+#if defined(__BMI2__) || (defined(_MSC_VER) && defined(__AVX2__))
+#    define YY_BMI2
+#    include <immintrin.h>
+#endif
+#endif
+
 #ifdef _MSC_VER
 #    define YY_ALIGN2( x )		    __declspec(align(2)) x
 #    define YY_ALIGN4( x )		    __declspec(align(4)) x
@@ -223,6 +247,18 @@ namespace yy {
     template<typename T> constexpr bool IsPod_v = IsPod<T>::value;
 
 
+    /************************************************************************************/
+    // 标识一个 POD 结构体 的序列化格式 即为其 内存映像( 小尾, 含对齐填充 ), 可整块 memcpy 读写( 含容器 ). 需显式特化开启
+    /*
+    template<> struct yy::IsRawLayout<Foo> : std::true_type {};
+    */
+
+    template<typename T, typename ENABLED = void>
+    struct IsRawLayout : std::false_type {
+    };
+    template<typename T> constexpr bool IsRawLayout_v = IsRawLayout<T>::value;
+
+
     /************************************************************************************/
     // Is 系列
 
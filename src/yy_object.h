@@ -30,22 +30,160 @@ namespace xx {
 }
 */
 
+	// 按 typeId 复用 对象内存块( 头部 + 对象 ) 的池. 非线程安全, 通过 ThreadLocal() 取当前线程的实例
+	// 对 Enable 过的 typeId, Make / Create 优先从池中取, shared_ptr / weak_ptr 释放时 放回池( 而非 free )
+	// 池中只存 malloc 所得 且 同 typeId 同长度 的块, 故 跨线程释放 也安全( 进入 释放线程 的池 )
+	/*
+		yy::object_pool::Enable<Foo>();			// 启动时, 开始高频 Create 之前
+		...
+		auto& s = yy::object_pool::ThreadLocal().Stat(yy::type_id_v<Foo>);	// s.hits, s.misses ...
+	*/
+	struct object_pool {
+		struct Bucket {
+			std::vector<void*> blocks;
+			size_t hits = 0;									// Alloc 复用了池中的块
+			size_t misses = 0;									// Alloc 池空 而 malloc
+			size_t recycles = 0;								// Free 放回池
+			size_t drops = 0;									// Free 池满 而 free
+		};
+		std::vector<Bucket> buckets;							// 下标为 typeId, 按需扩容
+		size_t maxBlocksPerType = 1024;							// 每个 typeId 最多缓存多少块, 超出直接 free
+
+		// 哪些 typeId 启用池化( 全局 )
+		inline static std::array<bool, 65536> enables{};
+
+		// 当前线程的池 是否已析构( 线程退出 / 程序结束时 仍有对象释放, 则直接 free )
+		inline static thread_local bool dead = false;
+
+		object_pool() = default;
+		object_pool(object_pool const&) = delete;
+		object_pool& operator=(object_pool const&) = delete;
+
+		~object_pool() {
+			dead = true;
+			Trim();
+		}
+
+		template<typename T>
+		static void Enable(bool const& b = true) {
+			static_assert(type_id_v<T> > 0);
+			enables[type_id_v<T>] = b;
+		}
+
+		// 当前线程的池
+		static object_pool& ThreadLocal() {
+			thread_local object_pool pool;
+			return pool;
+		}
+
+		YY_INLINE void* Alloc(uint16_t const& typeId, size_t const& siz) {
+			auto& b = Get(typeId);
+			if (b.blocks.empty()) {
+				++b.misses;
+				return malloc(siz);
+			}
+			++b.hits;
+			auto p = b.blocks.back();
+			b.blocks.pop_back();
+			return p;
+		}
+
+		YY_INLINE void Free(uint16_t const& typeId, void* const& p) {
+			auto& b = Get(typeId);
+			if (b.blocks.size() < maxBlocksPerType) {
+				++b.recycles;
+				b.blocks.push_back(p);
+			}
+			else {
+				++b.drops;
+				free(p);
+			}
+		}
+
+		// typeId 的 统计数据 及 池中块数( blocks.size() )
+		[[nodiscard]] YY_INLINE Bucket const& Stat(uint16_t const& typeId) {
+			return Get(typeId);
+		}
+
+		// 清 0 所有统计数据
+		void ResetStats() {
+			for (auto& b : buckets) {
+				b.hits = b.misses = b.recycles = b.drops = 0;
+			}
+		}
+
+		// 释放所有缓存的内存块
+		void Trim() {
+			for (auto& b : buckets) {
+				for (auto& p : b.blocks) {
+					free(p);
+				}
+				b.blocks.clear();
+			}
+		}
+
+	protected:
+		YY_INLINE Bucket& Get(uint16_t const& typeId) {
+			if (typeId >= buckets.size()) {
+				buckets.resize(typeId + 1);
+			}
+			return buckets[typeId];
+		}
+	};
+
 	// 扩展智能指针的头部, 直接包含 type id 以及 序列化过程中要使用到的 offset 变量占位
 	struct shared_ptr_object_header : shared_ptr_header {
 		union {
 			struct {
-				uint32_t typeId;        // 序列化 或 类型转换用
+				uint16_t typeId;        // 序列化 或 类型转换用
+				uint16_t flags;         // Flags 组合
 				uint32_t offset;        // 序列化等过程中使用
 			};
 			void* ud;
 		};
 
+		enum Flags : uint16_t {
+			FlagArena = 1,				// 内存块 来自 DataArena: 释放时 只析构 不归还, 随 arena Reset 整体回收
+		};
+
 		template<typename T>
 		void init() {
 			this->shared_ptr_header::init<T>();
 			typeId = type_id_v<T>;
+			flags = 0;
 			offset = 0;
 		}
+
+		// 于 arena 中 创建 T( 头部带 FlagArena )
+		template<typename T>
+		static shared_ptr<T> MakeIn(DataArena& arena) {
+			auto h = (shared_ptr_object_header*)arena.Alloc(sizeof(shared_ptr_object_header) + sizeof(T));
+			h->template init<T>();
+			h->flags = FlagArena;
+			shared_ptr<T> rtv;
+			rtv.pointer = new(h + 1) T();
+			return rtv;
+		}
+
+		// 启用了池化的 typeId 从 当前线程的 object_pool 分配 / 归还. arena 中的 不归还
+		template<typename T>
+		YY_INLINE static void* Alloc() {
+			constexpr auto siz = sizeof(shared_ptr_object_header) + sizeof(T);
+			if (object_pool::enables[type_id_v<T>] && !object_pool::dead) {
+				return object_pool::ThreadLocal().Alloc(type_id_v<T>, siz);
+			}
+			return malloc(siz);
+		}
+
+		YY_INLINE void Free() {
+			if (flags & FlagArena) return;
+			if (object_pool::enables[typeId] && !object_pool::dead) {
+				object_pool::ThreadLocal().Free(typeId, this);
+			}
+			else {
+				free(this);
+			}
+		}
 	};
 
 	struct object;
@@ -58,6 +196,8 @@ namespace xx {
 
 	using object_s = shared_ptr<object>;
 	struct object_handler;
+	template<typename T> struct object_reader;
+	struct object_parallel_writer;
 
 	/************************************************************************************/
 	// 接口函数适配模板. 特化 以扩展类型支持
@@ -106,6 +246,7 @@ namespace xx {
 	inline int RecursiveCheck(yy::object_handler& o) const override { }
 	inline void RecursiveReset(yy::object_handler& o) override { }
 	inline void SetDefaultValue(yy::object_handler& o) { }
+	inline size_t ComputeSize(yy::object_handler& o) const override { }		// 可选
 	*/
 
 	// object: 仅用于 shared_ptr<> weak_ptr<> 包裹的类型基类. 只能单继承. 否则影响父子判断
@@ -142,6 +283,9 @@ namespace xx {
 		// 恢复成员变量初始值
 		virtual void SetDefaultValue(object_handler& om) = 0;
 
+		// 计算 序列化后的长度( 与 Write 写入的字节数一致, 供 object_handler::ComputeSize 使用 ). 默认为 试写一次. 可重载以提速( 参考 om.SizeOf )
+		virtual size_t ComputeSize(object_handler& om) const;
+
 		// 注意: 如果类以值类型方式使用, 则下列函数不可用
 		// 注意: 下面两个函数, 不可以在析构函数中使用, 构造函数中使用也需要确保构造过程顺利无异常。另外，如果指定 T, 则 unsafe, 需小心确保 this 真的能转为 T
 		// 得到当前类的强指针
@@ -174,13 +318,310 @@ namespace xx {
 		static const uint16_t value = 0;
 	};
 
-	YY_HAS_TYPEDEF(IsSimpleType_v);
+	// 类内 using IsSimpleType_v = 类自身; 表示 "简单类型"( 见 object_handler::simples ). 派生类 继承来的 不算
+	template<typename, typename = void> struct HasTypedef_IsSimpleType_v : std::false_type {};
+	template<typename T> struct HasTypedef_IsSimpleType_v<T, std::void_t<typename T::IsSimpleType_v>> : std::is_same<typename T::IsSimpleType_v, T> {};
+	template<typename T> constexpr bool IsSimpleType_v = HasTypedef_IsSimpleType_v<T>::value;
+
+	// 线上格式 与 内存映像 相同 的 成员类型: 1 字节整数( 不含 bool ), 浮点 及 IsRawLayout 结构体( 小尾机 )
+	// YY_FIELDS 生成的代码 会把 内存中相邻 的 连续这类成员 合并为 一次 memcpy
+	template<typename T>
+#ifdef __BIG_ENDIAN__
+	constexpr bool IsRawWire_v = std::is_integral_v<T> && sizeof(T) == 1 && !std::is_same_v<T, bool>;
+#else
+	constexpr bool IsRawWire_v = IsFixedArrayElement_v<T> || IsRawLayout_v<T>;
+#endif
+
+	// YY_FIELDS 用: 父类 为 object 或 简单类型, 且 成员 都是 POD( 可平凡复制 且 非指针 ) 则 为 简单类型
+	template<typename BT, typename Tuple>
+	struct FieldsIsSimple;
+	template<typename BT, typename...TS>
+	struct FieldsIsSimple<BT, std::tuple<TS...>> : std::bool_constant<(std::is_same_v<BT, object> || IsSimpleType_v<BT>)
+		&& ((std::is_trivially_copyable_v<std::remove_reference_t<TS>> && !std::is_pointer_v<std::remove_cv_t<std::remove_reference_t<TS>>>) && ...)> {};
+
+	// YY_FIELDS 用: T 自身( 而非 仅其父类 ) 由 YY_FIELDS 生成
+	template<typename, typename = void> struct IsYyFields : std::false_type {};
+	template<typename T> struct IsYyFields<T, std::void_t<typename T::YyFieldsType>> : std::is_same<typename T::YyFieldsType, T> {};
+	template<typename T> constexpr bool IsYyFields_v = IsYyFields<T>::value;
+
+	// YY_FIELDS 用: 把 #__VA_ARGS__ 形如 "a, b,c" 拆成 { "a", "b", "c" }
+	template<size_t N>
+	constexpr std::array<std::string_view, N> SplitFieldNames(std::string_view s) {
+		std::array<std::string_view, N> r{};
+		for (size_t i = 0; i < N; ++i) {
+			auto e = s.find(',');
+			auto f = s.substr(0, e);
+			while (!f.empty() && (f.front() == ' ' || f.front() == '\t' || f.front() == '\n' || f.front() == '\r')) f.remove_prefix(1);
+			while (!f.empty() && (f.back() == ' ' || f.back() == '\t' || f.back() == '\n' || f.back() == '\r')) f.remove_suffix(1);
+			r[i] = f;
+			if (e == std::string_view::npos) break;
+			s.remove_prefix(e + 1);
+		}
+		return r;
+	}
+
+	// 对象访问记录( 对象头 -> 序号 ), 供 object_handler 旁路表模式 代替 对象头 offset 使用
+	// 开放寻址 线性探测. 槽位带 代数, Clear 只需 代数 + 1( 不清内存 ), 适合 每次序列化都清一次 的反复使用
+	struct visit_map {
+		struct Slot {
+			void const* key;
+			uint32_t gen;										// == visit_map::gen 表示 占用
+			uint32_t value;
+		};
+		std::vector<Slot> slots;								// 长度为 2^n
+		uint32_t gen = 1;
+		uint32_t count = 0;
+		uint32_t peak = 0;										// 历史最大元素个数( Clear 时 更新 )
+		int shift = 64;											// 64 - n
+
+		// 若 key 不存在 则插入 value. 返回 值的指针 及 是否新插入
+		YY_INLINE std::pair<uint32_t*, bool> TryEmplace(void const* const& key, uint32_t const& value) {
+			if ((count + 1) * 2 > slots.size()) {
+				Rehash(slots.empty() ? 64 : slots.size() * 2);
+			}
+			auto mask = slots.size() - 1;
+			for (auto i = Hash(key);; i = (i + 1) & mask) {
+				auto& o = slots[i];
+				if (o.gen != gen) {
+					o.key = key;
+					o.gen = gen;
+					o.value = value;
+					++count;
+					return { &o.value, true };
+				}
+				if (o.key == key) return { &o.value, false };
+			}
+		}
+
+		// 找不到 返回 nullptr
+		[[nodiscard]] YY_INLINE uint32_t* Find(void const* const& key) {
+			if (!count) return nullptr;
+			auto mask = slots.size() - 1;
+			for (auto i = Hash(key);; i = (i + 1) & mask) {
+				auto& o = slots[i];
+				if (o.gen != gen) return nullptr;
+				if (o.key == key) return &o.value;
+			}
+		}
+
+		// f(void const* key, uint32_t value)
+		template<typename F>
+		YY_INLINE void ForEach(F&& f) const {
+			if (!count) return;
+			for (auto& o : slots) {
+				if (o.gen == gen) {
+					f(o.key, o.value);
+				}
+			}
+		}
+
+		// 预留 至少能放 n 个 而不扩容 的空间
+		YY_INLINE void Reserve(size_t const& n) {
+			if (n * 2 > slots.size()) {
+				Rehash(Round2n(n * 2));
+			}
+		}
+
+		YY_INLINE void Clear() {
+			if (!count) return;
+			if (count > peak) {
+				peak = count;
+			}
+			count = 0;
+			if (++gen == 0) {									// 代数 回绕: 真清一次
+				for (auto& o : slots) {
+					o.gen = 0;
+				}
+				gen = 1;
+			}
+		}
+
+		[[nodiscard]] YY_INLINE size_t Count() const {
+			return count;
+		}
+
+		// 清空 并 释放 槽位, peak 归 0
+		void Trim() {
+			slots = {};
+			count = 0;
+			peak = 0;
+			gen = 1;
+			shift = 64;
+		}
+
+	protected:
+		YY_INLINE size_t Hash(void const* const& key) const {
+			return size_t(((uint64_t)(size_t)key * 0x9E3779B97F4A7C15ull) >> shift);
+		}
+
+		YY_NOINLINE void Rehash(size_t const& siz) {
+			std::vector<Slot> old(siz);
+			std::swap(old, slots);
+			shift = 64 - Calc2n(siz);
+			auto mask = siz - 1;
+			for (auto& o : old) {
+				if (o.gen != gen) continue;
+				auto i = Hash(o.key);
+				while (slots[i].gen == gen) {
+					i = (i + 1) & mask;
+				}
+				slots[i] = o;
+			}
+		}
+	};
+
+	// object_parallel_writer 的 分块认领 状态: 各块 以 原子操作 把 对象头 offset 由 0 写为 stamp + 块内序号( 认领 ), 之后 凭此 去重
+	// 已被 别的块 认领 的对象 改记 旁路表. 重写时( gids 非空 ) 只读 认领结果, 按 gids 把 块内序号 换成 全局序号
+	struct visit_claim {
+		uint32_t stamp = 0;										// 本块 认领值 范围为 ( stamp, stamp + range ]
+		uint32_t range = 0;
+		std::vector<shared_ptr_object_header*> claimed;			// 本块 认领的 对象头( 事后 清 0 )
+		std::vector<uint32_t> gids;								// 重写用: 块内序号 -> 全局序号. <= base 的 为 前面块 已写过 的对象
+		uint32_t base = 0;										// 重写用: 本块之前 已分配的 序号数
+		uint32_t assigned = 0;									// 重写用: 已写到的 本块新对象 个数
+	};
+
+	// object_handler 的 临时表: 带 N 个元素 的 内置空间, 不超过 N 个时 不分配内存. clear 保留容量, 反复使用 稳定后 不再分配
+	// 记录 历史最大元素个数( peak ), Trim 释放 堆上的空间( 退回 内置空间 ). 只支持 平凡析构 的元素
+	template<typename T, size_t N>
+	struct scratch_vector {
+		static_assert(std::is_trivially_destructible_v<T>);
+		alignas(T) uint8_t inl[sizeof(T) * N];
+		T* buf = (T*)inl;
+		size_t len = 0;
+		size_t cap = N;
+		size_t peak = 0;										// 历史最大元素个数( clear / 缩小 时 更新 )
+
+		scratch_vector() = default;
+
+		scratch_vector(scratch_vector const& o) {
+			operator=(o);
+		}
+
+		scratch_vector& operator=(scratch_vector const& o) {
+			if (this != &o) {
+				clear();
+				reserve(o.len);
+				for (size_t i = 0; i < o.len; ++i) {
+					new (&buf[i]) T(o.buf[i]);
+				}
+				len = o.len;
+			}
+			return *this;
+		}
+
+		~scratch_vector() {
+			if (buf != (T*)inl) {
+				free(buf);
+			}
+		}
+
+		[[nodiscard]] YY_INLINE size_t size() const { return len; }
+		[[nodiscard]] YY_INLINE bool empty() const { return !len; }
+		[[nodiscard]] YY_INLINE size_t capacity() const { return cap; }
+		[[nodiscard]] YY_INLINE T* data() const { return buf; }
+		[[nodiscard]] YY_INLINE T* begin() const { return buf; }
+		[[nodiscard]] YY_INLINE T* end() const { return buf + len; }
+		[[nodiscard]] YY_INLINE T& operator[](size_t const& i) const { assert(i < len); return buf[i]; }
+		[[nodiscard]] YY_INLINE T& back() const { assert(len); return buf[len - 1]; }
+
+		YY_INLINE void push_back(T const& v) {
+			emplace_back(v);
+		}
+
+		template<typename...Args>
+		YY_INLINE T& emplace_back(Args&&...args) {
+			if (len == cap) {
+				Grow(len + 1);
+			}
+			return *new (&buf[len++]) T(std::forward<Args>(args)...);
+		}
+
+		YY_INLINE void resize(size_t const& n) {
+			if (n > len) {
+				reserve(n);
+				for (auto i = len; i < n; ++i) {
+					new (&buf[i]) T();
+				}
+			}
+			else if (len > peak) {
+				peak = len;
+			}
+			len = n;
+		}
+
+		YY_INLINE void reserve(size_t const& n) {
+			if (n > cap) {
+				Grow(n);
+			}
+		}
+
+		YY_INLINE void clear() {
+			if (len > peak) {
+				peak = len;
+			}
+			len = 0;
+		}
+
+		// 清空 并 释放 堆上的空间, peak 归 0
+		void Trim() {
+			clear();
+			if (buf != (T*)inl) {
+				free(buf);
+				buf = (T*)inl;
+				cap = N;
+			}
+			peak = 0;
+		}
+
+	protected:
+		YY_NOINLINE void Grow(size_t const& n) {
+			auto c = std::max(cap * 2, n);
+			auto p = (T*)malloc(sizeof(T) * c);
+			if (!p) throw std::bad_alloc();						// 原 空间 仍有效
+			for (size_t i = 0; i < len; ++i) {
+				new (&p[i]) T(buf[i]);
+			}
+			if (buf != (T*)inl) {
+				free(buf);
+			}
+			buf = p;
+			cap = c;
+		}
+	};
 
 	struct object_handler {
-		// 公共上下文
-		std::vector<void*> ptrs;								// for write, append, clone
-		std::vector<void*> ptrs2;								// for read, clone
-		std::vector<std::pair<shared_ptr_object_header*, shared_ptr_object_header**>> weaks;	// for clone
+		// 公共上下文. 各临时表 跨调用 保留容量, 可用 Trim 释放
+		scratch_vector<void*, 32> ptrs;							// for write, append, clone
+		scratch_vector<void*, 16> ptrs2;						// for read, clone
+		scratch_vector<std::pair<shared_ptr_object_header*, shared_ptr_object_header**>, 8> weaks;	// for clone
+		Data scratch;											// for compute size( 试写 )
+
+		// 旁路表 模式: 写入 / 计算长度 / Append / Clone / 循环引用检查 的 访问记录 存于 sideIdxs 而非 对象头 offset
+		// 不修改图( 不会 弄脏 每个被访问对象 的 缓存行 ), 多个 object_handler 可同时 只读遍历 同一个图
+		bool sideTable = false;
+		visit_map sideIdxs;										// 对象头 -> 序号
+		uint32_t sideCount = 0;									// 已分配的 最大序号
+
+		// 分块认领 模式( 供 object_parallel_writer, 需 sideTable 为 true ): 非空 则 优先 认领对象头, 旁路表 只记 别的块 认领了的 对象
+		visit_claim* claim = nullptr;
+
+		// 序号位置记录( 供 object_parallel_writer 事后平移序号 ): 非空 则 写入 idxData 的 每个 序号 的 偏移 依次记入 idxOffsets
+		Data const* idxData = nullptr;
+		std::vector<size_t> idxOffsets;
+
+		// arena 模式: 非空 则 Read 新建的对象( 含头部 ) 都从 arena 顺序切分, 内存连续, 释放时 只析构 不 free
+		// 整个图 用完( 所有 shared_ptr / weak_ptr 都已释放 ) 后 arena->Reset() 一次回收. Reset 之后 残留的指针 全部失效
+		/*
+			yy::DataArena arena;
+			om.arena = &arena;
+			{ std::vector<yy::shared_ptr<Foo>> req; om.ReadFrom(d, req); ... }
+			arena.Reset();
+		*/
+		DataArena* arena = nullptr;
+
+		template<typename T> friend struct object_reader;
+		friend struct object_parallel_writer;
 
 		inline static object_s null;
 
@@ -190,12 +631,28 @@ namespace xx {
 		// typeId 创建函数 映射容器
 		inline static std::array<FT, 65536> fs{};
 
+		// 于 arena 中 创建 的 类创建函数
+		typedef object_s(*AFT)(DataArena&);
+
+		// typeId arena 创建函数 映射容器
+		inline static std::array<AFT, 65536> afs{};
+
 		// 存储 typeId 的 父typeId 的下标
 		inline static std::array<uint16_t, 65536> pids{};
 
 		// 存储 typeId 对应的 Type 是否为 "简单类型"( 只含有基础数据类型, 可跳过递归检测，简化序列化操作 )
 		inline static std::array<bool, 65536> simples{};
 
+		// typeId 对应的 动态类型 是否 正是 U. 是 则 可 直接调用 U::Write 等( 静态分派: 免 虚函数调用, 且 可内联 )
+		// U 为 final 时 编译期 恒为 true. 否则 比较 typeId( 相等 即 对象 不是 U 的子类, 无需 知道 U 有无子类 )
+		template<typename U>
+		YY_INLINE static bool IsExactType(uint16_t const& typeId) noexcept {
+			static_assert(std::is_base_of_v<object, U>);
+			if constexpr (std::is_abstract_v<U>) return false;
+			else if constexpr (std::is_final_v<U>) return true;
+			else return typeId == type_id_v<U>;
+		}
+
 		// 根据 typeid 判断父子关系
 		YY_INLINE static bool IsBaseOf(uint32_t const& baseTypeId, uint32_t typeId) noexcept {
 			for (; typeId != baseTypeId; typeId = pids[typeId]) {
@@ -241,10 +698,9 @@ namespace xx {
 			static_assert(std::is_base_of_v<object, T>);
 			pids[type_id_v<T>] = type_id_v<typename T::BaseType>;
 			fs[type_id_v<T>] = []() -> object_s { return Make<T>(); };
+			afs[type_id_v<T>] = [](DataArena& a) -> object_s { return shared_ptr_object_header::MakeIn<T>(a); };
 			if constexpr (IsSimpleType_v<T>) {
-				if constexpr (std::is_same_v<typename T::IsSimpleType_v, T>) {
-					simples[type_id_v<T>] = true;
-				}
+				simples[type_id_v<T>] = true;
 			}
 		}
 
@@ -254,8 +710,36 @@ namespace xx {
 			return fs[typeId]();
 		}
 
+		// 根据 typeId 来创建对象. arena 非空 则于其中创建. 失败返回空
+		YY_INLINE static object_s Create(uint16_t const& typeId, DataArena* const& arena) {
+			if (!arena) return Create(typeId);
+			if (!typeId || !afs[typeId]) return nullptr;
+			return afs[typeId](*arena);
+		}
+
+		// 各临时表 的 历史最大元素个数( scratch 为 容量 ). 可据此 决定 是否 Trim
+		struct Peaks {
+			size_t ptrs, ptrs2, weaks, sideIdxs, scratch;
+		};
+
+		[[nodiscard]] Peaks GetPeaks() const {
+			return { std::max(ptrs.peak, ptrs.len), std::max(ptrs2.peak, ptrs2.len), std::max(weaks.peak, weaks.len)
+				, std::max<size_t>(sideIdxs.peak, sideIdxs.count), scratch.cap };
+		}
+
+		// 释放 各临时表 占用的内存( 退回 内置空间 ), 历史最大值 归 0. 处理过 特别大的图 之后 可调用. 不可在 读写 过程中调用
+		void Trim() {
+			assert(ptrs.empty() && ptrs2.empty() && weaks.empty() && !sideIdxs.Count());
+			ptrs.Trim();
+			ptrs2.Trim();
+			weaks.Trim();
+			sideIdxs.Trim();
+			scratch.Clear(true);
+		}
+
         // 向 data 写入数据( 支持 shared_ptr<T> 或 T 结构体 ). 会初始化写入上下文, 并在写入结束后擦屁股( 主要入口 )
-		// 如果 v 是 shared_ptr<T> 类型 且 v 的类型 和 T 完全一致( 并非基类 ), 则可 令 direct = true 以加速写入操作
+		// 如果 v 是 shared_ptr<T> 类型 且 v 的类型 和 T 完全一致( 并非基类 ), 则可 令 direct = true 以加速写入操作( T 为 final 时 自动 视为 direct )
+		// 各层 shared_ptr<T> 所指对象 的 动态类型 正是 T 时( 见 IsExactType ), 直接调用 T::Write, 不走 虚函数
 		// 如果有预分配 data 的内存，可设置 needReserve 为 false. 主要针对结构体嵌套的简单类型. 遇到 "类" 会阻断 ( 需有充分把握，最好在结束后 assert( d.len <= d.cap ) )
 		template<bool needReserve = true, bool direct = false, typename T>
 		YY_INLINE void WriteTo(Data& d, T const& v) {
@@ -265,7 +749,7 @@ namespace xx {
 				if constexpr (direct) {
 					assert(((shared_ptr_object_header*)v.pointer - 1)->typeId == type_id_v<U>);
 				}
-				if constexpr (direct && IsSimpleType_v<U>) {
+				if constexpr ((direct || std::is_final_v<U>) && IsSimpleType_v<U>) {
 					d.WriteVarInteger<needReserve>(type_id_v<U>);
 					v.pointer->U::Write(*this, d);
 					return;
@@ -274,7 +758,7 @@ namespace xx {
 					auto tid = ((shared_ptr_object_header*)v.pointer - 1)->typeId;
 					if (simples[tid]) {
 						d.WriteVarInteger<needReserve>(tid);
-						Write_<needReserve>(d, *v.pointer);
+						WriteObject_(d, *v.pointer, tid);
 						return;
 					}
 					else {
@@ -286,10 +770,7 @@ namespace xx {
 				Write_<needReserve>(d, v);
 			}
 			if constexpr (!IsSimpleType_v<T>) {
-				for (auto&& p : ptrs) {
-					*(uint32_t*)p = 0;
-				}
-				ptrs.clear();
+				ClearVisits();
 			}
 		}
 
@@ -300,7 +781,168 @@ namespace xx {
             WriteTo<needReserve, direct, T>(d, v);
 		}
 
+		// 计算 WriteTo 将要写入的字节数( 精确 ). 与 WriteTo 走相同的分派( 含 shared_ptr 去重, 变长整数, 容器 )
+		// 未实现 ComputeSize 的 类 / 结构体 以 试写 的方式计算
+		template<bool direct = false, typename T>
+		YY_INLINE size_t ComputeSize(T const& v) {
+			size_t r;
+			if constexpr (IsShared_v<T>) {
+				assert(v);
+				using U = typename T::ElementType;
+				if constexpr ((direct || std::is_final_v<U>) && IsSimpleType_v<U>) {
+					return VarIntSize(type_id_v<U>) + v.pointer->U::ComputeSize(*this);
+				}
+				else {
+					auto tid = ((shared_ptr_object_header*)v.pointer - 1)->typeId;
+					if (simples[tid]) return VarIntSize(tid) + SizeObject_(*v.pointer, tid);
+					r = Size_<true>(v);
+				}
+			}
+			else {
+				r = Size_(v);
+			}
+			if constexpr (!IsSimpleType_v<T>) {
+				ClearVisits();
+			}
+			return r;
+		}
+
+		// 先 ComputeSize 一次性 预留空间, 再走 免检查 的写入( WriteTo<false> )
+		// 注意: 类( object 派生 ) 的 Write 内部 仍为检查写入
+		template<bool direct = false, typename T>
+		YY_INLINE void WriteToExact(Data& d, T const& v) {
+			auto siz = d.len + ComputeSize<direct>(v);
+			d.Reserve(siz);
+			WriteTo<false, direct>(d, v);
+			assert(d.len == siz);
+		}
+
+		// 试写: 以 f(Data&) 向 scratch 写入 并返回写入长度. 可嵌套
+		template<typename F>
+		YY_INLINE size_t DryWrite(F&& f) {
+			auto bak = scratch.len;
+			f(scratch);
+			auto r = scratch.len - bak;
+			scratch.len = bak;
+			return r;
+		}
+
     protected:
+		// 访问记录: 首次访问 h 则分配序号 并返回 true. 序号 默认临时存于 h->offset( 经 ptrs 事后清 0 ), 旁路表模式 存于 sideIdxs
+		YY_INLINE bool Visit(shared_ptr_object_header* const& h, uint32_t& idx) {
+			if (sideTable) {
+				if (claim) return VisitClaim(h, idx);
+				auto r = sideIdxs.TryEmplace(h, sideCount + 1);
+				if (r.second) {
+					++sideCount;
+				}
+				idx = *r.first;
+				return r.second;
+			}
+			if (h->offset == 0) {
+				ptrs.push_back(&h->offset);
+				h->offset = (uint32_t)ptrs.size();
+				idx = h->offset;
+				return true;
+			}
+			idx = h->offset;
+			return false;
+		}
+
+		// 分块认领 模式 的 Visit. 重写时 访问的对象 都在 首次写入时 访问过( 已认领 或 在旁路表中 )
+		YY_INLINE bool VisitClaim(shared_ptr_object_header* const& h, uint32_t& idx) {
+			auto& c = *claim;
+			std::atomic_ref<uint32_t> offset(h->offset);
+			auto o = offset.load(std::memory_order_relaxed);
+			uint32_t l;
+			if (o - c.stamp - 1 < c.range) {
+				l = o - c.stamp;
+				if (c.gids.empty()) {
+					idx = l;
+					return false;
+				}
+			}
+			else if (c.gids.empty()) {
+				if (!o && sideCount < c.range && offset.compare_exchange_strong(o, c.stamp + sideCount + 1, std::memory_order_relaxed)) {
+					c.claimed.push_back(h);
+					idx = ++sideCount;
+					return true;
+				}
+				auto r = sideIdxs.TryEmplace(h, sideCount + 1);
+				if (r.second) {
+					++sideCount;
+				}
+				idx = *r.first;
+				return r.second;
+			}
+			else {
+				l = *sideIdxs.Find(h);
+			}
+			idx = c.gids[l];
+			if (idx <= c.base || idx - c.base <= c.assigned) return false;
+			assert(idx - c.base == c.assigned + 1);
+			++c.assigned;
+			return true;
+		}
+
+		// 已访问 h 则返回其序号, 否则返回 0
+		YY_INLINE uint32_t VisitedIdx(shared_ptr_object_header* const& h) {
+			if (sideTable) {
+				auto p = sideIdxs.Find(h);
+				return p ? *p : 0;
+			}
+			return h->offset;
+		}
+
+		// 即将向 d 写入 序号: 需要时 记下 其偏移
+		YY_INLINE void RecordIdxOffset(Data const& d) {
+			if (&d == idxData) {
+				idxOffsets.push_back(d.len);
+			}
+		}
+
+		// 各入口 结束后 清除访问记录
+		YY_INLINE void ClearVisits() {
+			for (auto&& p : ptrs) {
+				*(uint32_t*)p = 0;
+			}
+			ptrs.clear();
+			sideIdxs.Clear();
+			sideCount = 0;
+		}
+
+		// 写 / 读 / 算长 shared_ptr 所指对象 的内容. 动态类型 正是 U 时 静态分派
+		template<typename U>
+		YY_INLINE void WriteObject_(Data& d, U const& o, uint16_t const& typeId) {
+			if constexpr (!std::is_abstract_v<U>) {
+				if (IsExactType<U>(typeId)) {
+					o.U::Write(*this, d);
+					return;
+				}
+			}
+			o.Write(*this, d);
+		}
+
+		template<typename U>
+		YY_INLINE int ReadObject_(Data_r& d, U& o, uint16_t const& typeId) {
+			if constexpr (!std::is_abstract_v<U>) {
+				if (IsExactType<U>(typeId)) {
+					return o.U::Read(*this, d);
+				}
+			}
+			return o.Read(*this, d);
+		}
+
+		template<typename U>
+		YY_INLINE size_t SizeObject_(U const& o, uint16_t const& typeId) {
+			if constexpr (!std::is_abstract_v<U>) {
+				if (IsExactType<U>(typeId)) {
+					return o.U::ComputeSize(*this);
+				}
+			}
+			return o.ComputeSize(*this);
+		}
+
 		// 内部函数
 		template<bool needReserve = true, bool isFirst = false, typename T>
 		YY_INLINE void Write_(Data& d, T const& v) {
@@ -313,19 +955,20 @@ namespace xx {
 						d.WriteFixed<needReserve>((uint8_t)0);
 					}
 					else {
-						// 写入格式： idx + typeId + content ( idx 临时存入 h->offset )
+						// 写入格式： idx + typeId + content ( idx 临时存入 h->offset 或 旁路表 )
 						auto h = ((shared_ptr_object_header*)v.pointer - 1);
-						if (h->offset == 0) {
-							ptrs.push_back(&h->offset);
-							h->offset = (uint32_t)ptrs.size();
+						uint32_t idx;
+						if (Visit(h, idx)) {
 							if constexpr (!isFirst) {
-								d.WriteVarInteger<needReserve>(h->offset);
+								RecordIdxOffset(d);
+								d.WriteVarInteger<needReserve>(idx);
 							}
 							d.WriteVarInteger<needReserve>(h->typeId);
-							Write_<needReserve>(d, *v.pointer);
+							WriteObject_(d, *v.pointer, h->typeId);
 						}
 						else {
-							d.WriteVarInteger<needReserve>(h->offset);
+							RecordIdxOffset(d);
+							d.WriteVarInteger<needReserve>(idx);
 						}
 					}
 				}
@@ -363,12 +1006,20 @@ namespace xx {
 			else if constexpr (IsVector_v<T> || IsSetSeries_v<T> || IsQueueSeries_v<T>) {
 				d.WriteVarInteger<needReserve>(v.size());
 				if (v.empty()) return;
-				if constexpr (IsVector_v < T> && (sizeof(T) == 1 || std::is_floating_point_v<T>)) {
+				using E = typename T::value_type;
+				if constexpr (IsVector_v<T> && IsFixedArrayElement_v<E>) {
 					d.WriteFixedArray<needReserve>(v.data(), v.size());
 				}
-				else if constexpr (std::is_integral_v<typename T::value_type>) {
+				else if constexpr (IsVector_v<T> && IsRawLayout_v<E>) {
+					static_assert(RawLayoutCheck<E>());
+					d.WriteBuf<needReserve>(v.data(), v.size() * sizeof(E));
+				}
+				else if constexpr (IsVector_v<T> && std::is_integral_v<E>) {
+					d.WriteVarIntegers<needReserve>(v.data(), v.size());
+				}
+				else if constexpr (std::is_integral_v<E> && sizeof(E) >= 2) {
 					if constexpr (needReserve) {
-						auto cap = v.size() * (sizeof(T) + 1);
+						auto cap = d.len + v.size() * VarIntMaxSize_v<typename T::value_type>;		// 按元素最大变长长度 预留
 						if (d.cap < cap) {
 							d.Reserve<false>(cap);
 						}
@@ -411,7 +1062,8 @@ namespace xx {
 					}, v);
 			}
 			else if constexpr (IsPair_v<T>) {
-				Write<needReserve>(v.first, v.second);
+				Write_<needReserve>(d, v.first);
+				Write_<needReserve>(d, v.second);
 			}
 			else if constexpr (IsMapSeries_v<T>) {
 				d.WriteVarInteger<needReserve>(v.size());
@@ -419,6 +1071,13 @@ namespace xx {
 					Write<needReserve>(d, kv.first, kv.second);
 				}
 			}
+			else if constexpr (IsRawLayout_v<T>) {
+				static_assert(RawLayoutCheck<T>());
+				d.WriteBuf<needReserve>(&v, sizeof(T));
+			}
+			else if constexpr (IsEncodedVector_v<T>) {
+				d.Write<needReserve>(v);
+			}
 			else {
 				if constexpr (needReserve) {
 					object_interface<T>::Write(*this, d, v);
@@ -437,8 +1096,173 @@ namespace xx {
 			(Write_<needReserve>(d, args), ...);
 		}
 
+		// 供 YY_FIELDS 生成的代码调用. t 为 std::tie( 成员... ). 同 Write, 但 连续的 IsRawWire_v 成员 若 内存中也相邻, 则 合并为 一次 定长 WriteBuf
+		// ( 分组 在编译期 完成. 相邻判断 为 this 相对地址 比较, 内联后 折叠为常量 )
+		template<typename Tup>
+		YY_INLINE void WriteFields(Data& d, Tup const& t) {
+			WriteFields_<0>(d, t);
+		}
+
+	protected:
+		// 从 I 开始 连续 IsRawWire_v 成员 的 结束下标
+		template<size_t I, typename Tup>
+		static constexpr size_t RawRunEnd() {
+			if constexpr (I < std::tuple_size_v<Tup>) {
+				if constexpr (IsRawWire_v<std::remove_cvref_t<std::tuple_element_t<I, Tup>>>) {
+					return RawRunEnd<I + 1, Tup>();
+				}
+				else return I;
+			}
+			else return I;
+		}
+
+		// [I, E) 成员 的 长度和
+		template<size_t I, size_t E, typename Tup>
+		static constexpr size_t RawRunSize() {
+			return[]<size_t...Js>(std::index_sequence<Js...>) {
+				return (sizeof(std::remove_cvref_t<std::tuple_element_t<I + Js, Tup>>) + ...);
+			}(std::make_index_sequence<E - I>());
+		}
+
+		// [I, E) 成员 在内存中 是否 首尾相接
+		template<size_t I, size_t E, typename Tup>
+		YY_INLINE static bool RawRunAdjacent(Tup const& t) {
+			if constexpr (I + 1 >= E) return true;
+			else return (uint8_t const*)&std::get<I + 1>(t) == (uint8_t const*)&std::get<I>(t) + sizeof(std::get<I>(t))
+				&& RawRunAdjacent<I + 1, E>(t);
+		}
+
+		template<size_t I, typename Tup>
+		YY_INLINE void WriteFields_(Data& d, Tup const& t) {
+			if constexpr (I < std::tuple_size_v<Tup>) {
+				constexpr auto E = RawRunEnd<I, Tup>();
+				if constexpr (E > I + 1) {
+					if (RawRunAdjacent<I, E>(t)) {
+						d.WriteBuf(&std::get<I>(t), RawRunSize<I, E, Tup>());
+						WriteFields_<E>(d, t);
+						return;
+					}
+				}
+				Write_(d, std::get<I>(t));
+				WriteFields_<I + 1>(d, t);
+			}
+		}
+
+	protected:
+		// 内部函数. 与 Write_ 一一对应
+		template<bool isFirst = false, typename T>
+		YY_INLINE size_t Size_(T const& v) {
+			if constexpr (IsShared_v<T>) {
+				using U = typename T::ElementType;
+				if constexpr (std::is_base_of_v<object, U>) {
+					if (!v) return 1;
+					auto h = ((shared_ptr_object_header*)v.pointer - 1);
+					uint32_t idx;
+					if (Visit(h, idx)) {
+						size_t r = 0;
+						if constexpr (!isFirst) {
+							r = VarIntSize(idx);
+						}
+						return r + VarIntSize(h->typeId) + SizeObject_(*v.pointer, h->typeId);
+					}
+					return VarIntSize(idx);
+				}
+				else {
+					return v ? 1 + Size_(*v) : 1;
+				}
+			}
+			else if constexpr (IsWeak_v<T>) {
+				if (!v) return 1;
+				auto p = v.h + 1;
+				return Size_(*(shared_ptr<typename T::ElementType>*) & p);
+			}
+			else if constexpr (std::is_base_of_v<object, T>) {
+				return v.ComputeSize(*this);
+			}
+			else if constexpr (IsOptional_v<T>) {
+				return v.has_value() ? 1 + Size_(*v) : 1;
+			}
+			else if constexpr (IsVector_v<T> || IsSetSeries_v<T> || IsQueueSeries_v<T>) {
+				using E = typename T::value_type;
+				size_t r = VarIntSize(v.size());
+				if constexpr (std::is_floating_point_v<E> || IsRawLayout_v<E> || (std::is_integral_v<E> && sizeof(E) == 1)) {
+					r += v.size() * sizeof(E);
+				}
+				else if constexpr (std::is_integral_v<E>) {
+					for (auto&& o : v) {
+						r += VarIntSize(o);
+					}
+				}
+				else {
+					for (auto&& o : v) {
+						r += Size_(o);
+					}
+				}
+				return r;
+			}
+			else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>) {
+				return VarIntSize(v.size()) + v.size();
+			}
+			else if constexpr (std::is_base_of_v<Span, T>) {
+				return VarIntSize(v.len) + v.len;
+			}
+			else if constexpr (std::is_integral_v<T>) {
+				if constexpr (sizeof(T) == 1) return 1;
+				else return VarIntSize(v);
+			}
+			else if constexpr (std::is_enum_v<T>) {
+				return Size_(*(std::underlying_type_t<T>*) & v);
+			}
+			else if constexpr (std::is_floating_point_v<T>) {
+				return sizeof(T);
+			}
+			else if constexpr (IsTuple_v<T>) {
+				return std::apply([&](auto const &... args) {
+					return (Size_(args) + ... + size_t(0));
+					}, v);
+			}
+			else if constexpr (IsPair_v<T>) {
+				return Size_(v.first) + Size_(v.second);
+			}
+			else if constexpr (IsMapSeries_v<T>) {
+				size_t r = VarIntSize(v.size());
+				for (auto&& kv : v) {
+					r += Size_(kv.first) + Size_(kv.second);
+				}
+				return r;
+			}
+			else if constexpr (IsRawLayout_v<T>) {
+				return sizeof(T);
+			}
+			else if constexpr (IsEncodedVector_v<T>) {
+				using E = typename T::value_type;
+				if constexpr (T::encoding == IntEncodings::FixedLE) {
+					return VarIntSize(v.size()) + v.size() * sizeof(E);
+				}
+				else {
+					return DryWrite([&](Data& d) { d.Write(v); });
+				}
+			}
+			else if constexpr (requires { object_interface<T>::ComputeSize(*this, v); }) {
+				return object_interface<T>::ComputeSize(*this, v);
+			}
+			else {
+				return DryWrite([&](Data& d) { object_interface<T>::Write(*this, d, v); });
+			}
+		}
+
+	public:
+		// 供类成员函数 重载 ComputeSize 时调用. 返回 Write 这些参数 的字节数
+		template<typename...Args>
+		YY_INLINE size_t SizeOf(Args const&...args) {
+			static_assert(sizeof...(args) > 0);
+			return (Size_(args) + ...);
+		}
+
 		// 从 data 读入 / 反序列化, 填充到 v. ( 支持 shared_ptr<T> 或 T 结构体 )( 主要入口 )
 		// 原则: 尽量值覆盖, 不新建对象
+		// std::string_view, Span, Data_r 类型的成员为 借用 解码: 指向 d 的内存而非复制, 生命周期与 d 的内存绑定
+		// 适合只读查询: 成员声明为借用类型 即可零分配解码. d 释放或复用( 含 RemoveFront, 扩容 ) 后 这些成员即失效
 		template<typename T>
 		YY_INLINE int ReadFrom(Data_r& d, T& v) {
 			auto r = Read_<T, IsShared_v<T>>(d, v);
@@ -465,6 +1289,22 @@ namespace xx {
 			return ReadTuple<I + 1, Tp...>(d, t);
 		}
 
+		// 读失败时 重置 ptrs[from..]( 本次新建的对象 ) 的成员, 斩断可能的循环引用. 不递归, 不影响 之前已读出的对象
+		// ( 读时 ptrs 存的是对象指针, 不可用 KillRecursive: 它会 把 ptrs 当作 offset 指针 清 0 )
+		YY_INLINE void ResetReadObjects(size_t const& from) {
+			auto siz = ptrs.size();
+			for (auto i = from; i < siz; ++i) {
+				++((shared_ptr_object_header*)ptrs[i] - 1)->shared_count;		// 先持有, 避免 重置时 被连带释放
+			}
+			for (auto i = from; i < siz; ++i) {
+				((object*)ptrs[i])->SetDefaultValue(*this);
+			}
+			for (auto i = from; i < siz; ++i) {
+				object_s o;
+				o.pointer = (object*)ptrs[i];
+			}
+		}
+
 		// 内部函数
 		template<typename T, bool isFirst = false>
 		YY_INLINE int Read_(Data_r& d, T& v) {
@@ -492,12 +1332,13 @@ namespace xx {
                         if (!fs[typeId]) return __LINE__;
 						if (!IsBaseOf<U>(typeId)) return __LINE__;
 
-						if (!v || v.typeId() != typeId) {
-							v = std::move(Create(typeId).template ReinterpretCast<U>());
+						// 原对象 类型相同 且 未被别处持有 才原地复用( 否则 会改到 别处 引用的对象, 例如 原图中 共享的节点 被 两个新对象 先后覆盖 )
+						if (!v || v.GetHeader()->typeId != typeId || v.GetSharedCount() != 1) {
+							v = std::move(Create(typeId, arena).template ReinterpretCast<U>());
 							assert(v);
 						}
 						ptrs.emplace_back(v.pointer);
-						if (int r = Read_(d, *v)) return r;
+						if (int r = ReadObject_(d, *v, typeId)) return r;
 					}
 					else {
 						if (idx > len) return __LINE__;
@@ -522,8 +1363,10 @@ namespace xx {
 			}
 			else if constexpr (IsWeak_v<T>) {
 				shared_ptr<typename T::ElementType> o;
+				auto np = ptrs.size();
 				if (int r = Read_(d, o)) {
-					KillRecursive(o);
+					ResetReadObjects(np);
+					ptrs.resize(np);								// 这些对象 随 o 释放
 					return r;
 				}
 				v = o;
@@ -555,8 +1398,15 @@ namespace xx {
 				v.resize(siz);
 				if (siz == 0) return 0;
 				auto buf = v.data();
-				if constexpr (sizeof(T) == 1 || std::is_floating_point_v<T>) {
-					d.ReadFixedArray(buf, siz);
+				using E = typename T::value_type;
+				if constexpr (IsFixedArrayElement_v<E>) {
+					if (int r = d.ReadFixedArray(buf, siz)) return r;
+				}
+				else if constexpr (IsRawLayout_v<E>) {
+					if (int r = d.ReadBuf(buf, siz * sizeof(E))) return r;
+				}
+				else if constexpr (std::is_integral_v<E> && sizeof(E) >= 2) {
+					if (int r = d.ReadVarIntegers(buf, siz)) return r;
 				}
 				else {
 					for (size_t i = 0; i < siz; ++i) {
@@ -600,6 +1450,20 @@ namespace xx {
 				d.offset += siz;
 				return 0;
 			}
+			else if constexpr (std::is_same_v<T, std::string_view> || std::is_same_v<T, Span> || std::is_same_v<T, Data_r>) {
+				// 借用: 直接指向 d 的内存, 不复制不分配. d 的内存( 含 MappedData 的映射 ) 必须比 v 活得久
+				size_t siz;
+				if (int r = Read_(d, siz)) return r;
+				if (d.offset + siz > d.len) return __LINE__;
+				if constexpr (std::is_same_v<T, std::string_view>) {
+					v = std::string_view((char*)d.buf + d.offset, siz);
+				}
+				else {
+					v.Reset(d.buf + d.offset, siz);
+				}
+				d.offset += siz;
+				return 0;
+			}
 			else if constexpr (std::is_integral_v<T>) {
 				if constexpr (sizeof(T) == 1) {
 					if (int r = d.ReadFixed(v))  return __LINE__ * 1000000 + r;
@@ -617,10 +1481,10 @@ namespace xx {
 				return 0;
 			}
 			else if constexpr (IsTuple_v<T>) {
-				return ReadTuple(v);
+				return ReadTuple(d, v);
 			}
 			else if constexpr (IsPair_v<T>) {
-				return Read(v.first, v.second);
+				return Read_(d, v.first, v.second);
 			}
 			else if constexpr (IsMapSeries_v<T>) {
 				size_t siz;
@@ -634,6 +1498,12 @@ namespace xx {
 				}
 				return 0;
 			}
+			else if constexpr (IsRawLayout_v<T>) {
+				return d.ReadBuf(&v, sizeof(T));
+			}
+			else if constexpr (IsEncodedVector_v<T>) {
+				return d.Read(v);
+			}
 			else {
 				return object_interface<T>::Read(*this, d, v);;
 			}
@@ -654,16 +1524,38 @@ namespace xx {
 			return Read_(d, args...);
 		}
 
+		// 供 YY_FIELDS 生成的代码调用. t 为 std::tie( 成员... ). 同 Read, 但 连续的 IsRawWire_v 成员 若 内存中也相邻, 则 合并为 一次 定长 ReadBuf
+		template<typename Tup>
+		YY_INLINE int ReadFields(Data_r& d, Tup const& t) {
+			return ReadFields_<0>(d, t);
+		}
+
+	protected:
+		template<size_t I, typename Tup>
+		YY_INLINE int ReadFields_(Data_r& d, Tup const& t) {
+			if constexpr (I < std::tuple_size_v<Tup>) {
+				constexpr auto E = RawRunEnd<I, Tup>();
+				if constexpr (E > I + 1) {
+					if (RawRunAdjacent<I, E>(t)) {
+						if (int r = d.ReadBuf(&std::get<I>(t), RawRunSize<I, E, Tup>())) return r;
+						return ReadFields_<E>(d, t);
+					}
+				}
+				if (int r = Read_(d, std::get<I>(t))) return r;
+				return ReadFields_<I + 1>(d, t);
+			}
+			else return 0;
+		}
+
+	public:
+
 
 		// 向 s 写入数据. 会初始化写入上下文, 并在写入结束后擦屁股( 主要入口 )
 		template<typename...Args>
 		YY_INLINE void AppendTo(std::string& s, Args const&...args) {
 			static_assert(sizeof...(args) > 0);
 			(Append_(s, args), ...);
-			for (auto&& p : ptrs) {
-				*(uint32_t*)p = 0;
-			}
-			ptrs.clear();
+			ClearVisits();
 		}
 
 		// 内部函数
@@ -677,13 +1569,12 @@ namespace xx {
 				if (v) {
 					if constexpr (std::is_same_v<U, object> || type_id_v<U> > 0) {
 						auto h = ((shared_ptr_object_header*)v.pointer - 1);
-						if (h->offset == 0) {
-							ptrs.push_back(&h->offset);
-							h->offset = (uint32_t)ptrs.size();
+						uint32_t idx;
+						if (Visit(h, idx)) {
 							Append_(s, *v);
 						}
 						else {
-							s.append(std::to_string(h->offset));
+							s.append(std::to_string(idx));
 						}
 					}
 					else {
@@ -708,7 +1599,7 @@ namespace xx {
 					s.append("null");
 				}
 			}
-			else if constexpr (IsVector_v<T> || IsSetSeries_v<T> || IsQueueSeries_v<T>) {
+			else if constexpr (IsVector_v<T> || IsSetSeries_v<T> || IsQueueSeries_v<T> || IsEncodedVector_v<T>) {
 				s.push_back('[');
 				if (!v.empty()) {
 					for (auto&& o : v) {
@@ -765,6 +1656,14 @@ namespace xx {
 			(Append_(s, args), ...);
 		}
 
+		// 供 YY_FIELDS 生成的 AppendCore 调用. 逐个追加 "名字":值, 以 逗号 分隔( 紧跟 { 的 第一个 不加 )
+		template<size_t N, typename...Args>
+		YY_INLINE void AppendFields(std::string& s, std::array<std::string_view, N> const& names, Args const&...args) {
+			static_assert(N == sizeof...(args));
+			size_t i = 0;
+			((s.append(!s.empty() && s.back() != '{' ? ",\"" : "\"").append(names[i++]).append("\":"), Append_(s, args)), ...);
+		}
+
 
 		// 字符串拼接，方便输出
 		template<typename...Args>
@@ -781,8 +1680,8 @@ namespace xx {
 		YY_INLINE void CloneTo(T const& in, T& out) {
 			Clone_(in, out);
 			for (auto& kv : weaks) {
-				if (kv.first->offset) {
-					auto h = (shared_ptr_object_header*)ptrs2[kv.first->offset - 1] - 1;
+				if (auto idx = VisitedIdx(kv.first)) {
+					auto h = (shared_ptr_object_header*)ptrs2[idx - 1] - 1;
 					++h->weak_count;
 					*kv.second = h;
 				}
@@ -791,10 +1690,7 @@ namespace xx {
 					++kv.first->weak_count;
 				}
 			}
-			for (auto&& p : ptrs) {
-				*(uint32_t*)p = 0;
-			}
-			ptrs.clear();
+			ClearVisits();
 			ptrs2.clear();
 			weaks.clear();
 		}
@@ -807,6 +1703,17 @@ namespace xx {
 			return out;
 		}
 
+		// 供 YY_FIELDS 生成的 Clone 调用. in out 为 std::tie 成员 所得 的 tuple
+		template<typename TI, typename TO>
+		YY_INLINE void CloneFields(TI const& in, TO const& out) {
+			CloneFields_(in, out, std::make_index_sequence<std::tuple_size_v<TI>>());
+		}
+
+		template<typename TI, typename TO, size_t...Is>
+		YY_INLINE void CloneFields_(TI const& in, TO const& out, std::index_sequence<Is...>) {
+			(Clone_(std::get<Is>(in), std::get<Is>(out)), ...);
+		}
+
 		template<class Tuple, std::size_t N>
 		struct TupleForeachClone {
 			YY_INLINE static void Clone(object_handler& self, Tuple const& in, Tuple& out) {
@@ -831,19 +1738,18 @@ namespace xx {
 					}
 					else {
 						auto h = ((shared_ptr_object_header*)in.pointer - 1);
-						if (h->offset == 0) {
-							ptrs.push_back(&h->offset);
-							h->offset = (uint32_t)ptrs.size();
-
-							auto inTypeId = in.typeId();
-							if (out.typeId() != inTypeId) {
+						uint32_t idx;
+						if (Visit(h, idx)) {
+							auto inTypeId = h->typeId;
+							// 同 Read_: 只原地复用 类型相同 且 未被别处持有 的 原对象
+							if (!out || out.GetHeader()->typeId != inTypeId || out.GetSharedCount() != 1) {
 								out = std::move(Create(inTypeId).template ReinterpretCast<U>());
 							}
 							ptrs2.push_back(out.pointer);
 							Clone_(*in, *out);
 						}
 						else {
-							out = *(T*)&ptrs2[h->offset - 1];
+							out = *(T*)&ptrs2[idx - 1];
 						}
 					}
 				}
@@ -879,7 +1785,9 @@ namespace xx {
 				auto siz = in.size();
 				out.resize(siz);
 				if constexpr (IsPod_v<typename T::value_type>) {
-					memcpy(out.data(), in.data(), siz * sizeof(typename T::value_type));
+					if (siz) {
+						memcpy(out.data(), in.data(), siz * sizeof(typename T::value_type));
+					}
 				}
 				else {
 					for (size_t i = 0; i < siz; ++i) {
@@ -913,7 +1821,7 @@ namespace xx {
 					out.insert(std::move(tar));
 				}
 			}
-			else if constexpr (std::is_same_v<std::string, T> || std::is_base_of_v<Span, T>) {
+			else if constexpr (std::is_same_v<std::string, T> || std::is_same_v<std::string_view, T> || std::is_base_of_v<Span, T>) {
 				out = in;
 			}
 			else {
@@ -927,10 +1835,7 @@ namespace xx {
 		YY_INLINE void KillRecursive(Args&...args) {
 			static_assert(sizeof...(args) > 0);
 			(RecursiveReset_(args), ...);
-			for (auto&& p : ptrs) {
-				*(uint32_t*)p = 0;
-			}
-			ptrs.clear();
+			ClearVisits();
 		}
 
 	protected:
@@ -939,9 +1844,8 @@ namespace xx {
 			if constexpr (IsShared_v<T>) {
 				if (v) {
 					auto h = ((shared_ptr_object_header*)v.pointer - 1);
-					if (h->offset == 0) {
-						h->offset = 1;
-						ptrs.push_back(&h->offset);
+					uint32_t idx;
+					if (Visit(h, idx)) {
 						RecursiveReset_(*v);
 					}
 					else {
@@ -978,7 +1882,7 @@ namespace xx {
 					RecursiveReset_(kv.second);
 				}
 			}
-			else if constexpr (std::is_same_v<std::string, T> || std::is_base_of_v<Span, T>) {
+			else if constexpr (std::is_same_v<std::string, T> || std::is_same_v<std::string_view, T> || std::is_base_of_v<Span, T>) {
 			}
 			else {
 				object_interface<T>::RecursiveReset(*this, v);
@@ -1003,10 +1907,7 @@ namespace xx {
 		YY_INLINE int HasRecursive(Args const&...args) {
 			static_assert(sizeof...(args) > 0);
 			auto r = RecursiveCheck_(args...);
-			for (auto&& p : ptrs) {
-				*(uint32_t*)p = 0;
-			}
-			ptrs.clear();
+			ClearVisits();
 			return r;
 		}
 
@@ -1027,12 +1928,11 @@ namespace xx {
 			if constexpr (IsShared_v<T>) {
 				if (v) {
 					auto h = ((shared_ptr_object_header*)v.pointer - 1);
-					if (h->offset == 0) {
-						ptrs.push_back(&h->offset);
-						h->offset = (uint32_t)ptrs.size();
+					uint32_t idx;
+					if (Visit(h, idx)) {
 						return RecursiveCheck_(*v);
 					}
-					else return h->offset;
+					else return idx;
 				}
 			}
 			else if constexpr (IsWeak_v<T>) {
@@ -1061,7 +1961,7 @@ namespace xx {
 					if (int r = RecursiveCheck_(kv.second)) return r;
 				}
 			}
-			else if constexpr (std::is_same_v<std::string, T> || std::is_base_of_v<Span, T>) {
+			else if constexpr (std::is_same_v<std::string, T> || std::is_same_v<std::string_view, T> || std::is_base_of_v<Span, T>) {
 			}
 			else {
 				return object_interface<T>::RecursiveCheck(*this, v);
@@ -1097,7 +1997,19 @@ namespace xx {
 			(SetDefaultValue_(args), ...);
 		}
 
+		// 供 YY_FIELDS 生成的 SetDefaultValue 调用. tar src 为 std::tie 成员 所得 的 tuple, src 来自 默认构造 的 临时对象
+		// 逐个 移入 tar, 从而 保留 成员声明处 的 初始值( 如 int hp = 100; )
+		template<typename TS>
+		YY_INLINE void SetDefaultFields(TS const& tar, TS const& src) {
+			SetDefaultFields_(tar, src, std::make_index_sequence<std::tuple_size_v<TS>>());
+		}
+
 	protected:
+		template<typename TS, size_t...Is>
+		YY_INLINE void SetDefaultFields_(TS const& tar, TS const& src, std::index_sequence<Is...>) {
+			((std::get<Is>(tar) = std::move(std::get<Is>(src))), ...);
+		}
+
 		template<typename T>
 		YY_INLINE void SetDefaultValue_(T& v) {
 			if constexpr (IsShared_v<T> || IsWeak_v<T>) {
@@ -1109,10 +2021,13 @@ namespace xx {
 			else if constexpr (std::is_same_v<Data, T>) {
 				v.Clear();
 			}
+			else if constexpr (std::is_same_v<T, std::string_view> || std::is_same_v<T, Span> || std::is_same_v<T, Data_r>) {
+				v = T();
+			}
 			else if constexpr (IsOptional_v<T>) {
 				v.reset();
 			}
-			else if constexpr (IsVector_v<T> || IsSetSeries_v<T> || IsQueueSeries_v<T> || IsMapSeries_v<T> || std::is_same_v<T, std::string>) {
+			else if constexpr (IsVector_v<T> || IsSetSeries_v<T> || IsQueueSeries_v<T> || IsMapSeries_v<T> || IsEncodedVector_v<T> || std::is_same_v<T, std::string>) {
 				v.clear();
 			}
 			else if constexpr (IsTuple_v<T>) {
@@ -1167,6 +2082,160 @@ namespace xx {
 			std::cout.flush();
 		}
 	};
+
+	inline size_t object::ComputeSize(object_handler& om) const {
+		return om.DryWrite([&](Data& d) { Write(om, d); });
+	}
+
+	/************************************************************************************/
+	// 续读解码: 数据分段到达时 收一段 解一段, 不必收齐整包再 ReadFrom. 结果与 ReadFrom 相同
+	// 续读粒度为 元素: T 为容器( vector, set, queue, map ) 时 为其单个元素, 否则为 整个 T
+	// 某元素数据不全时 回滚到该元素起点( 含 ptrs 表 ), 返回 -1 等待更多数据. 已解出的元素 及 ptrs 表 保留, 之后不重复解码
+	// 只缓存 未解完的元素 的字节( 其他字节 直接从 Feed 的参数 解码, 不复制 )
+	// 解码失败时 无法区分 数据不全 与 数据错误: 已知总长( 构造时传入 ) 则 收齐后的失败 即为错误; 否则 未解完的字节 超过 maxPending 视为错误
+	// 已知总长 时 某元素 重试失败 后, 未解完的字节 翻倍 或 收齐 才再重试, 故 大元素 分 k 段到达 的 解码总代价 仍为 O(n)
+	// 总长未知 时 无法判断 何时收齐, 每次 Feed 都会重试 未解完的元素( 单个大元素 分 k 段到达 代价 O(k·n) ), 能拿到 包长 时 请传入
+	// 注意: 不支持 借用 解码( string_view, Span, Data_r ): 解码所用的内存 在 Feed 之后不再有效
+	/*
+		std::vector<yy::shared_ptr<Foo>> foos;
+		yy::object_reader<decltype(foos)> rd(om, foos, pkgLen);
+		while (...) {
+			auto n = recv(fd, tmp, sizeof(tmp), 0);
+			int r = rd.Feed(tmp, n);
+			if (r == -1) continue;
+			if (r) ... 出错
+			break;  // 完成
+		}
+	*/
+	template<typename T>
+	struct object_reader {
+		static constexpr bool isContainer = IsVector_v<T> || IsSetSeries_v<T> || IsQueueSeries_v<T> || IsMapSeries_v<T>;
+
+		object_handler& om;
+		T& v;
+		Data buf;											// 未解完的字节
+		size_t total;										// 总长( 0: 未知 )
+		size_t received = 0;								// 已收到的字节数
+		size_t maxPending = 1024 * 1024 * 64;				// 总长未知时 未解完字节数 上限
+		size_t retryLen = 0;								// 总长已知时 未解完字节数 达到此值 才重试
+		size_t siz = 0;										// 容器元素个数
+		size_t i = 0;										// 容器 当前元素下标
+		int state = 0;										// 0: 未开始 1: 已读元素个数 2: 完成
+
+		object_reader(object_handler& om, T& v, size_t const& total = 0) : om(om), v(v), total(total) {
+			assert(om.ptrs.empty() && om.ptrs2.empty());
+		}
+		object_reader(object_reader const&) = delete;
+		object_reader& operator=(object_reader const&) = delete;
+
+		~object_reader() {
+			Cleanup();
+		}
+
+		// 追加 收到的数据 并尽量解码. 返回 0: 完成; -1: 需要更多数据; 其他: 出错( 出错 / 完成 后不可再 Feed )
+		YY_NOINLINE int Feed(void const* const& p, size_t const& n) {
+			assert(state < 2);
+			received += n;
+			int r;
+			if (buf.len) {
+				buf.WriteBuf(p, n);
+				if (buf.len < retryLen && received < total) return -1;
+				Data_r d(buf.buf, buf.len);
+				r = Step(d);
+				buf.RemoveFront(d.offset);
+			}
+			else {
+				Data_r d((uint8_t*)p, n);
+				r = Step(d);
+				if (d.offset < n) {
+					buf.WriteBuf((uint8_t*)p + d.offset, n - d.offset);
+				}
+			}
+			if (r != -1) {
+				state = 2;
+				Cleanup();
+			}
+			else if (total) {
+				retryLen = buf.len * 2;
+			}
+			return r;
+		}
+
+	protected:
+		// 同 ReadFrom 的收尾: 清 ptrs, 释放 weak_ptr 临时持有
+		YY_INLINE void Cleanup() {
+			om.ptrs.clear();
+			ReleasePtrs2(0);
+		}
+
+		YY_INLINE void ReleasePtrs2(size_t const& from) {
+			for (size_t j = from; j < om.ptrs2.size(); ++j) {
+				object_s o;
+				o.pointer = (object*)om.ptrs2[j];
+			}
+			om.ptrs2.resize(from);
+		}
+
+		// 解一个元素. 失败则回滚 d.offset 及 ptrs 表, 并判断是 等待数据( -1 ) 还是 出错
+		template<bool isFirst = false, typename...US>
+		YY_INLINE int TryRead(Data_r& d, US&...os) {
+			auto offset = d.offset;
+			auto np = om.ptrs.size();
+			auto np2 = om.ptrs2.size();
+			int r;
+			if constexpr (sizeof...(US) == 1) {
+				r = om.template Read_<US..., isFirst>(d, os...);
+			}
+			else {
+				r = om.Read_(d, os...);
+			}
+			if (!r) return 0;
+			d.offset = offset;
+			om.ResetReadObjects(np);
+			om.ptrs.resize(np);
+			ReleasePtrs2(np2);
+			if (total ? received >= total : d.len - offset > maxPending) return r;
+			return -1;
+		}
+
+		YY_INLINE int Step(Data_r& d) {
+			if constexpr (isContainer) {
+				if (state == 0) {
+					if (int r = TryRead(d, siz)) return r;
+					if (total && siz > total) return __LINE__;
+					v.clear();
+					state = 1;
+				}
+				for (; i < siz; ++i) {
+					if constexpr (IsVector_v<T>) {
+						if (i == v.size()) {
+							v.emplace_back();
+						}
+						if (int r = TryRead(d, v[i])) return r;
+					}
+					else if constexpr (IsMapSeries_v<T>) {
+						MapSeries_Pair_t<T> kv;
+						if (int r = TryRead(d, kv.first, kv.second)) return r;
+						v.insert(std::move(kv));
+					}
+					else {
+						typename T::value_type o;
+						if (int r = TryRead(d, o)) return r;
+						if constexpr (IsDeque_v<T>) {
+							v.push_back(std::move(o));
+						}
+						else {
+							v.insert(std::move(o));
+						}
+					}
+				}
+				return 0;
+			}
+			else {
+				return TryRead<IsShared_v<T>>(d, v);
+			}
+		}
+	};
 }
 
 
@@ -1187,6 +2256,72 @@ int RecursiveCheck(yy::object_handler& o) const override; \
 void RecursiveReset(yy::object_handler& o) override; \
 void SetDefaultValue(yy::object_handler& o) override;
 
+// 由 成员列表 生成 YY_OBJ_OBJECT_H 声明的 全部函数( 内联 ) 及 ComputeSize. 需放在 所列成员 的声明 之后. 列表中 不含 父类成员( 会先调 父类函数 )
+// SetDefaultValue 从 默认构造 的 临时对象 取值, 成员声明处 的 初始值 会被保留
+// 成员 都是 POD 且 父类 为 object 或 简单类型 则 自动标记为 简单类型. 内存中相邻 的 连续 IsRawWire_v 成员 合并 读写
+/*
+	struct Foo : yy::object {
+		int32_t id = 0;
+		float x = 0, y = 0;
+		std::string name;
+		yy::shared_ptr<Foo> next;
+		YY_FIELDS(Foo, yy::object, id, x, y, name, next)
+	};
+*/
+#define YY_FIELDS(T, BT, ...) \
+using BaseType = BT; \
+using IsSimpleType_v = std::conditional_t<yy::FieldsIsSimple<BT, decltype(std::tie(__VA_ARGS__))>::value, T, void>; \
+using YyFieldsType = T; \
+T() = default; \
+T(T const&) = default; \
+T& operator=(T const&) = default; \
+T(T&& o) = default; \
+T& operator=(T&& o) = default; \
+YY_INLINE auto YyFields() const { return std::tie(__VA_ARGS__); } \
+YY_INLINE auto YyFields() { return std::tie(__VA_ARGS__); } \
+void Write(yy::object_handler& o, yy::Data& d) const override { \
+	if constexpr (!std::is_same_v<BT, yy::object>) BT::Write(o, d); \
+	o.WriteFields(d, YyFields()); \
+} \
+int Read(yy::object_handler& o, yy::Data_r& d) override { \
+	if constexpr (!std::is_same_v<BT, yy::object>) { if (int r = BT::Read(o, d)) return r; } \
+	return o.ReadFields(d, YyFields()); \
+} \
+void Append(yy::object_handler& o, std::string& s) const override { \
+	s.push_back('{'); \
+	AppendCore(o, s); \
+	s.push_back('}'); \
+} \
+void AppendCore(yy::object_handler& o, std::string& s) const override { \
+	if constexpr (!std::is_same_v<BT, yy::object>) BT::AppendCore(o, s); \
+	using TS = decltype(YyFields()); \
+	static constexpr auto names = yy::SplitFieldNames<std::tuple_size_v<TS>>(#__VA_ARGS__); \
+	std::apply([&](auto const&...fs) { o.AppendFields(s, names, fs...); }, YyFields()); \
+} \
+void Clone(yy::object_handler& o, void* const& tar) const override { \
+	if constexpr (!std::is_same_v<BT, yy::object>) BT::Clone(o, tar); \
+	o.CloneFields(YyFields(), ((T*)tar)->YyFields()); \
+} \
+int RecursiveCheck(yy::object_handler& o) const override { \
+	if constexpr (!std::is_same_v<BT, yy::object>) { if (int r = BT::RecursiveCheck(o)) return r; } \
+	return std::apply([&](auto const&...fs) { int r = 0; (void)((r = o.RecursiveCheck(fs)) || ...); return r; }, YyFields()); \
+} \
+void RecursiveReset(yy::object_handler& o) override { \
+	if constexpr (!std::is_same_v<BT, yy::object>) BT::RecursiveReset(o); \
+	std::apply([&](auto&...fs) { (o.RecursiveReset(fs), ...); }, YyFields()); \
+} \
+void SetDefaultValue(yy::object_handler& o) override { \
+	if constexpr (!std::is_same_v<BT, yy::object>) BT::SetDefaultValue(o); \
+	T t; \
+	o.SetDefaultFields(YyFields(), t.YyFields()); \
+} \
+size_t ComputeSize(yy::object_handler& o) const override { \
+	size_t r = 0; \
+	if constexpr (yy::IsYyFields_v<BT>) r = BT::ComputeSize(o); \
+	else if constexpr (!std::is_same_v<BT, yy::object>) r = o.DryWrite([&](yy::Data& d) { BT::Write(o, d); }); \
+	return std::apply([&](auto const&...fs) { return (r + ... + o.SizeOf(fs)); }, YyFields()); \
+}
+
 #define YY_OBJ_STRUCT_H(T) \
 T() = default; \
 T(T const&) = default; \
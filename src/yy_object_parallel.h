@@ -0,0 +1,299 @@
+﻿#pragma once
+#include "yy_object.h"
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace yy {
+
+	// 并行写入: 把 顶层容器( vector, deque ) 的元素 分块, 交给多个线程 各自序列化, 再按顺序拼接. 输出与 object_handler::WriteTo(d, v) 逐字节相同
+	// 各块 以 原子操作 认领 对象头 offset 去重( 与 顺序写入 一样 只多碰 已要读的 对象头 ), 被 别的块 认领了的 对象 记入 本块 的旁路表
+	// 期间 不可修改 图, 也不可 同时 以 对象头 模式 遍历 它( 同 object_handler::WriteTo ). 结束前 清除 认领
+	// 共享对象 的序号 是全局按写入顺序分配的, 故分四步:
+	// 1. 并行 分块写入, 记录 各块 的对象数, 旁路表, 以及 各序号 在块内的偏移
+	// 2. 串行 合并: 只看 被多块 访问到的 对象( 旁路表 中的, 及其 认领者 ), 算出 每块 的 序号起点, 以及 块内 前面块已写过 的对象
+	// 3. 并行 修正各块 并 清除 本块的认领. 不含 前面块已写过 的对象 的块, 结构不变, 只需 按偏移 把 块内序号 平移 起点( 近似 memcpy )
+	//    含有的块 须 重写( 那些对象 在 1 中 被当作新对象 写了内容 ), 凭 本块的认领 及 旁路表 换算序号, 不再查 大表
+	// 4. 拼接
+	// 适合 元素多 且 元素间共享对象少 的大容器 快照. 块间共享越多, 2 的串行合并 及 3 的重写 越重
+	// 去重 借用 对象头 而非 各线程 只用 旁路表: 全走 旁路表 每个对象 多一次 哈希表 插入, 实测 单线程 约慢 3 倍, 多核 也难 赢回.
+	// 代价 是 写入期间 对象头 offset 被占用: 同一个图 不可 同时 有 别的 object_parallel_writer 或 对象头 模式 的 object_handler 在遍历
+	// ( 只读 并发遍历 请用 object_handler::sideTable ). 1 与 3 由 常驻 工作线程 执行( 首次 使用 时 创建, 跨调用 复用, 析构 时 退出 )
+	/*
+		yy::object_parallel_writer pw;
+		pw.WriteTo(d, world->entities);
+	*/
+	struct object_parallel_writer {
+		size_t numThreads = 0;									// 0: std::thread::hardware_concurrency()
+		size_t numChunks = 0;									// 0: 线程数 * 4
+
+		using Member = std::pair<uint32_t, void const*>;		// 块内序号, 对象头
+		struct Chunk {
+			size_t from, to;
+			Data data;
+			Data temp;											// 平移序号 用
+			visit_claim claim;
+			visit_map side;										// 本块 访问到的 别的块 认领了的 对象 -> 块内序号
+			std::vector<Member> shared;							// 本块 认领了的 而 别的块 也访问到的 对象
+			std::vector<std::pair<uint32_t, uint32_t>> seeds;	// 本块 访问到的 前面块已写过 的对象( 块内序号, 全局序号 ). 按 块内序号 排序
+			std::vector<size_t> idxOffsets;						// 1 的结果中 各序号 的偏移
+			uint32_t count = 0;									// 本块 访问到的 对象数
+			uint32_t base = 0;									// 本块之前 已分配的 序号数
+		};
+
+		// 各块 及 各线程的 object_handler 跨调用 复用( 缓冲 与 表 的容量 保留 ), 反复快照 时 应复用 同一个 object_parallel_writer
+		// 用 deque: 增加块数 时 已有块 不被搬动( Data 的 move 可能复制, 非 noexcept )
+		std::deque<Chunk> cs;
+		std::deque<object_handler> oms;
+		visit_map gids;											// 被多块 访问到的 对象 -> 全局序号
+		std::vector<Member> ms;
+
+		// 常驻 工作线程. Run 时 唤醒, 与 当前线程 一起 执行 同一个 job, 全部完成 才返回. 线程数 变化 时 重建
+		struct Pool {
+			std::vector<std::thread> ts;
+			std::mutex mtx;
+			std::condition_variable cv, cvDone;
+			std::function<void(size_t)> job;					// 参数: 线程下标( 当前线程 为 0 )
+			uint64_t gen = 0;									// 每次 Run + 1, 工作线程 据此 判断 有新 job
+			size_t busy = 0;									// 尚未完成 本次 job 的 工作线程 数
+			bool stop = false;
+
+			Pool() = default;
+			Pool(Pool const&) = delete;
+			Pool& operator=(Pool const&) = delete;
+
+			~Pool() {
+				Stop();
+			}
+
+			void Stop() {
+				{
+					std::lock_guard<std::mutex> g(mtx);
+					stop = true;
+				}
+				cv.notify_all();
+				for (auto& t : ts) {
+					t.join();
+				}
+				ts.clear();
+				stop = false;
+			}
+
+			// 以 n 个线程( 含 当前线程 ) 执行 f(线程下标). 当前线程 上的 f 抛异常 时 也会 等 工作线程 完成 再 抛出
+			template<typename F>
+			void Run(size_t const& n, F&& f) {
+				if (ts.size() != n - 1) {
+					Stop();
+					for (size_t t = 1; t < n; ++t) {
+						ts.emplace_back([this, t, g = gen] { Loop(t, g); });
+					}
+				}
+				{
+					std::lock_guard<std::mutex> g(mtx);
+					job = std::ref(f);
+					busy = n - 1;
+					++gen;
+				}
+				cv.notify_all();
+				std::exception_ptr e;
+				try {
+					f(0);
+				}
+				catch (...) {
+					e = std::current_exception();
+				}
+				{
+					std::unique_lock<std::mutex> g(mtx);
+					cvDone.wait(g, [this] { return !busy; });
+					job = nullptr;
+				}
+				if (e) {
+					std::rethrow_exception(e);
+				}
+			}
+
+		protected:
+			void Loop(size_t const& t, uint64_t seen) {
+				for (;;) {
+					{
+						std::unique_lock<std::mutex> g(mtx);
+						cv.wait(g, [&] { return stop || gen != seen; });
+						if (stop) return;
+						seen = gen;
+					}
+					job(t);
+					std::lock_guard<std::mutex> g(mtx);
+					if (!--busy) {
+						cvDone.notify_one();
+					}
+				}
+			}
+		} pool;
+
+		template<typename T>
+		void WriteTo(Data& d, T const& v) {
+			static_assert(IsVector_v<T> || IsDeque_v<T>);
+			using E = typename T::value_type;
+			if constexpr (std::is_arithmetic_v<E> || IsRawLayout_v<E>) {
+				WriteSequential(d, v);							// 元素 不含 共享对象, 顺序写 即可
+			}
+			else {
+				auto nt = numThreads ? numThreads : std::max<size_t>(1, std::thread::hardware_concurrency());
+				auto nc = std::min(v.size(), numChunks ? numChunks : nt * 4);
+				if (nt < 2 || nc < 2) {
+					WriteSequential(d, v);
+				}
+				else {
+					WriteChunks(d, v, nt, nc);
+				}
+			}
+		}
+
+	protected:
+		template<typename T>
+		void WriteSequential(Data& d, T const& v) {
+			if (oms.empty()) {
+				oms.emplace_back();
+			}
+			oms[0].sideTable = false;
+			oms[0].WriteTo(d, v);
+		}
+
+		template<typename T>
+		void WriteChunks(Data& d, T const& v, size_t const& nt, size_t const& nc) {
+			auto n = v.size();
+			cs.resize(nc);
+			auto range = uint32_t(0xFFFFFFFFu / nc);
+			for (size_t k = 0; k < nc; ++k) {
+				auto& c = cs[k];
+				c.from = n * k / nc;
+				c.to = n * (k + 1) / nc;
+				c.data.Clear();
+				c.claim.stamp = uint32_t(k) * range;
+				c.claim.range = range;
+				c.claim.claimed.clear();
+				c.claim.gids.clear();
+				c.claim.assigned = 0;
+				c.shared.clear();
+				c.seeds.clear();
+			}
+			while (oms.size() < nt) {
+				oms.emplace_back();
+			}
+			for (auto& om : oms) {
+				om.sideTable = true;
+			}
+
+			// 用 nt 个线程 ( 含当前线程 ) 处理完所有块
+			auto run = [&](auto&& f) {
+				std::atomic<size_t> next{ 0 };
+				pool.Run(nt, [&](size_t const& t) {
+					for (size_t k; (k = next++) < nc;) {
+						f(oms[t], cs[k]);
+					}
+				});
+			};
+			auto writeChunk = [&](object_handler& om, Chunk& c) {
+				om.claim = &c.claim;
+				for (auto i = c.from; i < c.to; ++i) {
+					om.Write_(c.data, v[i]);
+				}
+				om.claim = nullptr;
+			};
+
+			// 1
+			run([&](object_handler& om, Chunk& c) {
+				om.ClearVisits();
+				om.idxOffsets.clear();
+				om.idxData = &c.data;
+				writeChunk(om, c);
+				om.idxData = nullptr;
+				c.count = om.sideCount;
+				std::swap(c.side, om.sideIdxs);
+				std::swap(c.idxOffsets, om.idxOffsets);
+			});
+
+			// 2
+			for (auto& c : cs) {
+				c.side.ForEach([&](void const* p, uint32_t) {
+					if (auto o = ((shared_ptr_object_header*)p)->offset) {
+						auto& oc = cs[(o - 1) / range];
+						oc.shared.emplace_back(o - oc.claim.stamp, p);
+					}
+				});
+			}
+			gids.Clear();
+			uint32_t count = 0;
+			for (auto& c : cs) {
+				c.base = count;
+				ms.assign(c.shared.begin(), c.shared.end());
+				c.side.ForEach([&](void const* p, uint32_t l) {
+					ms.emplace_back(l, p);
+				});
+				std::sort(ms.begin(), ms.end());
+				ms.erase(std::unique(ms.begin(), ms.end()), ms.end());
+				for (auto& m : ms) {
+					auto r = gids.TryEmplace(m.second, c.base + m.first - (uint32_t)c.seeds.size());
+					if (!r.second) {
+						c.seeds.emplace_back(m.first, *r.first);
+					}
+				}
+				count += c.count - (uint32_t)c.seeds.size();
+			}
+
+			// 3
+			run([&](object_handler& om, Chunk& c) {
+				if (c.seeds.size()) {
+					auto& g = c.claim.gids;
+					g.resize(c.count + 1);
+					uint32_t skipped = 0;
+					for (uint32_t l = 1; l <= c.count; ++l) {
+						if (skipped < c.seeds.size() && c.seeds[skipped].first == l) {
+							g[l] = c.seeds[skipped++].second;
+						}
+						else {
+							g[l] = c.base + l - skipped;
+						}
+					}
+					c.claim.base = c.base;
+					c.data.Clear();
+					om.ClearVisits();
+					std::swap(om.sideIdxs, c.side);
+					writeChunk(om, c);
+				}
+				else if (c.base && c.idxOffsets.size()) {
+					// 块内序号 即 1 ~ count, 全局序号 为其 + base. 变长编码 可能变长, 故 写到 temp 再交换
+					auto& o = c.temp;
+					o.Clear();
+					o.Reserve(c.data.len + c.idxOffsets.size() * (VarIntMaxSize_v<uint32_t> - 1));
+					Data_r dr(c.data.buf, c.data.len);
+					for (auto offset : c.idxOffsets) {
+						o.WriteBuf<false>(c.data.buf + dr.offset, offset - dr.offset);
+						dr.offset = offset;
+						uint32_t idx = 0;
+						(void)dr.ReadVarInteger(idx);
+						o.WriteVarInteger<false>(idx + c.base);
+					}
+					o.WriteBuf<false>(c.data.buf + dr.offset, c.data.len - dr.offset);
+					std::swap(c.data, o);
+				}
+				for (auto h : c.claim.claimed) {						// 别的块 重写时 不看 本块的认领( 查旁路表 ), 故可 各自清除
+					std::atomic_ref<uint32_t>(h->offset).store(0, std::memory_order_relaxed);
+				}
+			});
+
+			// 4
+			size_t siz = VarIntMaxSize_v<size_t>;
+			for (size_t k = 0; k < nc; ++k) {
+				siz += cs[k].data.len;
+			}
+			d.Reserve(d.len + siz);
+			d.WriteVarInteger<false>(n);
+			for (size_t k = 0; k < nc; ++k) {
+				d.WriteBuf<false>(cs[k].data.buf, cs[k].data.len);
+			}
+		}
+	};
+}
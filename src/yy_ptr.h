@@ -18,6 +18,16 @@ namespace yy {
             shared_count = 1;
             weak_count = 0;
         }
+
+        // 分配 头部 + T 的内存块 / 释放. 派生的 header 可同名隐藏 以接管( 例如 按类型池化 )
+        template<typename T>
+        YY_INLINE static void* Alloc() {
+            return malloc(sizeof(shared_ptr_header) + sizeof(T));
+        }
+
+        YY_INLINE void Free() {
+            free(this);
+        }
     };
 
 
@@ -99,7 +109,7 @@ namespace yy {
                     pointer->~T();
                     pointer = nullptr;
                     if (h->weak_count == 0) {
-                        free(h);
+                        h->Free();
                     } else {
                         h->shared_count = 0;
                     }
@@ -238,7 +248,7 @@ namespace yy {
             pointer = nullptr;
             return std::shared_ptr<T>(bak, [](T *p) {
                 p->~T();
-                free((HeaderType *) p - 1);
+                ((HeaderType *) p - 1)->Free();
             });
         }
     };
@@ -274,7 +284,7 @@ namespace yy {
         YY_INLINE void Reset() {
             if (h) {
                 if (h->weak_count == 1 && h->shared_count == 0) {
-                    free(h);
+                    h->Free();
                 } else {
                     --h->weak_count;
                 }
@@ -408,8 +418,8 @@ namespace yy {
     template<typename...Args>
     shared_ptr<T> &shared_ptr<T>::Emplace(Args &&...args) {
         Reset();
-        auto h = (HeaderType *) malloc(sizeof(HeaderType) + sizeof(T));
-        h->init<T>();
+        auto h = (HeaderType *) HeaderType::template Alloc<T>();
+        h->template init<T>();
         pointer = new(h + 1) T(std::forward<Args>(args)...);
         return *this;
     }
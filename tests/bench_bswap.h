@@ -0,0 +1,51 @@
+﻿#pragma once
+#include "helpers.h"
+
+namespace yy_tests {
+
+	// 逐个 BSwap( 对 数组 循环调用 WriteFixedBE 的做法 ), 作 对照
+	template<typename T>
+	YY_NOINLINE void BSwapLoop(void const* const& in, void* const& out, size_t const& n) {
+		auto s = (uint8_t const*)in;
+		auto d = (uint8_t*)out;
+		T v;
+		for (size_t i = 0; i < n; ++i) {
+			memcpy(&v, s + i * sizeof(T), sizeof(T));
+			v = yy::BSwap(v);
+			memcpy(d + i * sizeof(T), &v, sizeof(T));
+		}
+	}
+
+	// 16 / 32 / 64 bit 数组 大尾 读写 速度: BSwapArray( 经 WriteFixedArrayBE / ReadFixedArrayBE ) vs 逐个 BSwap
+	template<typename T>
+	void BenchBSwapArray(size_t const& n) {
+		std::mt19937_64 rnd(1);
+		std::vector<T> src(n), dst(n);
+		for (auto& v : src) {
+			v = (T)rnd();
+		}
+		yy::Data d(sizeof(T) * n + 16);
+		auto write = BestMs(10, [&] {
+			d.Clear();
+			d.WriteFixedArrayBE<false>(src.data(), n);
+		});
+		auto read = BestMs(10, [&] {
+			yy::Data_r dr(d.buf, d.len);
+			(void)dr.ReadFixedArrayBE(dst.data(), n);
+		});
+		auto loop = BestMs(10, [&] {
+			BSwapLoop<T>(src.data(), d.buf, n);
+		});
+		KeepAlive(dst[n / 2] + d.buf[d.len / 2]);
+		auto mb = double(sizeof(T) * n) / 1024 / 1024;
+		printf("BSwapArray %2d-bit x %zu: WriteFixedArrayBE %6.0f MB/s, ReadFixedArrayBE %6.0f MB/s ( scalar BSwap loop %6.0f MB/s )\n"
+			, int(sizeof(T) * 8), n, mb / write * 1000, mb / read * 1000, mb / loop * 1000);
+	}
+
+	// 放在 L2 内 的 数组, 看 内核 本身 的 吞吐
+	inline void BenchBSwap() {
+		BenchBSwapArray<uint16_t>(65536);
+		BenchBSwapArray<uint32_t>(32768);
+		BenchBSwapArray<uint64_t>(16384);
+	}
+}
@@ -0,0 +1,72 @@
+﻿#pragma once
+#include "helpers.h"
+
+namespace yy_tests {
+	struct Small;
+	struct SmallFinal;
+}
+
+namespace yy {
+	template<>
+	struct type_id<yy_tests::Small> {
+		static const uint16_t value = 103;
+	};
+	template<>
+	struct type_id<yy_tests::SmallFinal> {
+		static const uint16_t value = 104;
+	};
+}
+
+namespace yy_tests {
+
+	// 同样的 成员, 一个 可被继承( 按 typeId 判断 后 静态分派 ), 一个 final( 编译期 即 静态分派 )
+	struct Small : yy::object {
+		int32_t id = 0;
+		float x = 0, y = 0;
+		std::string name;
+		YY_FIELDS(Small, yy::object, id, x, y, name)
+	};
+
+	struct SmallFinal final : yy::object {
+		int32_t id = 0;
+		float x = 0, y = 0;
+		std::string name;
+		YY_FIELDS(SmallFinal, yy::object, id, x, y, name)
+	};
+
+	template<typename T>
+	inline void BenchDispatch_(char const* const& tn) {
+		constexpr size_t n = 1000000;
+		std::mt19937_64 rnd(1);
+		std::vector<yy::shared_ptr<T>> v(n);
+		for (auto& o : v) {
+			o = yy::Make<T>();
+			o->id = (int32_t)rnd();
+			o->x = (float)(rnd() % 1000);
+			o->name.assign(rnd() % 8, 'n');
+		}
+		yy::object_handler om;
+		yy::Data d;
+		auto write = BestMs(5, [&] {
+			d.Clear();
+			om.WriteTo(d, v);
+		});
+		auto size = BestMs(5, [&] {
+			KeepAlive(om.ComputeSize(v));
+		});
+		auto read = BestMs(5, [&] {
+			std::vector<yy::shared_ptr<T>> r;
+			yy::Data_r dr(d.buf, d.len);
+			KeepAlive(om.ReadFrom(dr, r) + r.size());
+		});
+		printf("1M %s: WriteTo %6.1f ms, ComputeSize %6.1f ms, ReadFrom %6.1f ms\n", tn, write, size, read);
+	}
+
+	// vector< shared_ptr< 小对象 > > 的 写 / 算长 / 读: 对比 可被继承 与 final 的 元素类型
+	inline void BenchDispatch() {
+		yy::object_handler::Register<Small>();
+		yy::object_handler::Register<SmallFinal>();
+		BenchDispatch_<Small>("Small     ");
+		BenchDispatch_<SmallFinal>("SmallFinal");
+	}
+}
@@ -0,0 +1,55 @@
+﻿#pragma once
+#include "helpers.h"
+
+namespace yy_tests {
+
+	// 统计 复制字节数 的 分配器. Realloc 用 默认实现( Alloc + memcpy + Free ), 即 每次扩容 都 复制全部数据 的 旧做法
+	struct CopyCountAllocator : yy::DataAllocator {
+		size_t copied = 0;
+
+		void* Alloc(size_t const& siz) override {
+			return malloc(siz);
+		}
+
+		void Free(void* const& p, size_t const& /*siz*/) override {
+			free(p);
+		}
+
+		void* Realloc(void* const& p, size_t const& siz, size_t const& usedLen, size_t const& newSiz) override {
+			copied += usedLen;
+			return DataAllocator::Realloc(p, siz, usedLen, newSiz);
+		}
+	};
+
+	// Data 从 0 写到 1GB( 每次 64KB ): 复制扩容 vs realloc vs DataPageAllocator( mremap )
+	inline void BenchGrow() {
+		constexpr size_t total = 1024 * 1024 * 1024, step = 65536;
+		std::vector<uint8_t> chunk(step, 1);
+		auto run = [&](char const* name, yy::DataAllocator* a, size_t const* copied) {
+			size_t moves = 0;
+			auto ms = BestMs(1, [&] {
+				yy::Data d;
+				d.allocator = a;
+				uint8_t* last = nullptr;
+				for (size_t n = 0; n < total; n += step) {
+					d.WriteBuf(chunk.data(), step);
+					if (d.buf != last) {
+						last = d.buf;
+						++moves;
+					}
+				}
+				KeepAlive(d.buf[total - 1]);
+			});
+			printf("grow 0 -> 1GB %-28s %8.1f ms, buf moved %2zu times", name, ms, moves);
+			if (copied) {
+				printf(", copied %zu MB", *copied >> 20);
+			}
+			printf("\n");
+		};
+		CopyCountAllocator cca;
+		run("alloc + memcpy + free:", &cca, &cca.copied);
+		run("realloc:", nullptr, nullptr);
+		yy::DataPageAllocator pa;
+		run("DataPageAllocator(mremap):", &pa, nullptr);
+	}
+}
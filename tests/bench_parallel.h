@@ -0,0 +1,55 @@
+﻿#pragma once
+#include "test_parallel.h"
+
+namespace yy_tests {
+
+	// object_parallel_writer vs object_handler::WriteTo. 块间 无共享( 只平移序号 ) 与 稀疏跨块 weak 引用( 部分块 需重写 ) 两种图
+	// 单核机器上 并行 不会更快, 此时 看 相对顺序写 多出的开销( 1 的旁路表 + 3 ). 小容器 反复快照 主要看 线程 唤醒 的开销
+	inline void BenchParallelWrite() {
+		constexpr size_t n = 300000;
+		std::mt19937_64 rnd(1);
+		auto g = MakePrivateGraph(rnd, n);
+		for (auto& o : g) {
+			o->vals.resize(rnd() % 16, (int32_t)rnd());
+		}
+		yy::object_handler om;
+		yy::Data d0, d1;
+		for (int cross = 0; cross < 2; ++cross) {
+			if (cross) {
+				for (size_t i = 0; i < n; i += 4096) {
+					g[i]->parent = g[rnd() % n];
+				}
+			}
+			auto seq = BestMs(5, [&] {
+				d0.Clear();
+				om.WriteTo(d0, g);
+			});
+			printf("WriteTo %zu elements%s: sequential %6.1f ms", n, cross ? " ( sparse cross-chunk refs )" : "", seq);
+			for (size_t t : { 2, 4 }) {
+				yy::object_parallel_writer pw;
+				pw.numThreads = t;
+				auto par = BestMs(5, [&] {
+					d1.Clear();
+					pw.WriteTo(d1, g);
+				});
+				printf(", %zu threads %6.1f ms ( x%.2f )", t, par, seq / par);
+			}
+			printf(", hardware_concurrency %u\n", std::thread::hardware_concurrency());
+			KeepAlive(d0.len + d1.len + (d0 == d1));
+		}
+
+		auto small = MakePrivateGraph(rnd, 2000);
+		auto seq = BestMs(20, [&] {
+			d0.Clear();
+			om.WriteTo(d0, small);
+		});
+		yy::object_parallel_writer pw;
+		pw.numThreads = 4;
+		auto par = BestMs(20, [&] {
+			d1.Clear();
+			pw.WriteTo(d1, small);
+		});
+		printf("WriteTo %zu elements: sequential %6.3f ms, 4 threads %6.3f ms ( x%.2f )\n", small.size(), seq, par, seq / par);
+		KeepAlive(d0.len + d1.len + (d0 == d1));
+	}
+}
@@ -0,0 +1,55 @@
+﻿#pragma once
+#include "helpers.h"
+
+namespace yy_tests {
+
+	// 逐字节 循环 解码 varint( 无 64bit 整读 快速路径 ), 作 对照
+	template<typename T>
+	int ReadVarIntegerLoop(yy::Data_r& d, T& v) {
+		using UT = std::make_unsigned_t<T>;
+		UT u(0);
+		for (size_t shift = 0; shift < sizeof(T) * 8; shift += 7) {
+			if (d.offset == d.len) return __LINE__;
+			auto b = (UT)d.buf[d.offset++];
+			u |= UT((b & 0x7Fu) << shift);
+			if ((b & 0x80) == 0) {
+				v = u;
+				return 0;
+			}
+		}
+		return __LINE__;
+	}
+
+	// 1, 2, 3, 5 字节 变长整数 的 解码速度: ReadVarInteger vs 逐字节
+	inline void BenchVarInt() {
+		constexpr size_t n = 4000000;
+		std::mt19937_64 rnd(1);
+		for (int bytes : { 1, 2, 3, 5 }) {
+			auto lo = bytes == 1 ? 0 : uint64_t(1) << (7 * (bytes - 1));
+			auto hi = uint64_t(1) << (7 * bytes);
+			yy::Data d;
+			for (size_t i = 0; i < n; ++i) {
+				d.WriteVarInteger(lo + rnd() % (hi - lo));
+			}
+			uint64_t sum = 0;
+			auto fast = BestMs(5, [&] {
+				yy::Data_r dr(d.buf, d.len);
+				uint64_t v = 0;
+				for (size_t i = 0; i < n; ++i) {
+					(void)dr.ReadVarInteger(v);
+					sum += v;
+				}
+			});
+			auto loop = BestMs(5, [&] {
+				yy::Data_r dr(d.buf, d.len);
+				uint64_t v = 0;
+				for (size_t i = 0; i < n; ++i) {
+					(void)ReadVarIntegerLoop(dr, v);
+					sum += v;
+				}
+			});
+			KeepAlive(sum);
+			printf("ReadVarInteger %d-byte: %7.1f M/s ( byte loop %7.1f M/s )\n", bytes, n / fast / 1000, n / loop / 1000);
+		}
+	}
+}
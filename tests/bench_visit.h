@@ -0,0 +1,54 @@
+﻿#pragma once
+#include "test_object.h"
+
+namespace yy_tests {
+
+	// 浅而宽 的 共享图( 递归 不深 ): n / 2 个根 各有 私有的 next, kids 引用 随机 前面的根 的 next, parent 为 随机 前面的根
+	// 只引用 前面的根, 按顺序 遍历 时 被引用者 都已访问过, 递归 不会 沿着 随机链 走深
+	inline Graph MakeWideGraph(std::mt19937_64& rnd, size_t const& n) {
+		Graph g(n / 2);
+		for (auto& o : g) {
+			o = yy::Make<Node>();
+			o->name.assign(rnd() % 20, 'w');
+			o->vals.resize(rnd() % 8, (int32_t)rnd());
+			o->next = yy::Make<BigNode>();
+			o->next->parent = o;
+		}
+		for (size_t i = 1; i < g.size(); ++i) {
+			for (auto k = rnd() % 4; k; --k) {
+				g[i]->kids.push_back(g[rnd() % i]->next);
+			}
+			g[i]->parent = g[rnd() % i];
+		}
+		return g;
+	}
+
+	// 访问记录 存于 对象头 offset vs 旁路表( object_handler::sideTable ): 1M 节点 共享图 上 各遍历 的 毫秒数
+	// 旁路表 多一次 随机访存, 换来 不写 对象头, 可 多个 handler 同时 只读遍历 同一个图
+	inline void BenchVisit() {
+		std::mt19937_64 rnd(1);
+		auto g = MakeWideGraph(rnd, 1000000);
+		yy::Data d;
+		std::string s;
+		for (int side = 0; side < 2; ++side) {
+			yy::object_handler om;
+			om.sideTable = side;
+			auto write = BestMs(3, [&] {
+				d.Clear();
+				om.WriteTo(d, g);
+			});
+			auto size = BestMs(3, [&] {
+				KeepAlive(om.ComputeSize(g));
+			});
+			auto append = BestMs(3, [&] {
+				s.clear();
+				om.AppendTo(s, g);
+			});
+			auto clone = BestMs(3, [&] {
+				KeepAlive(om.Clone(g).size());
+			});
+			printf("1M nodes, %s: WriteTo %6.1f ms, ComputeSize %6.1f ms, AppendTo %6.1f ms, Clone %6.1f ms\n"
+				, side ? "side table" : "header    ", write, size, append, clone);
+		}
+	}
+}
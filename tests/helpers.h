@@ -0,0 +1,29 @@
+﻿#pragma once
+#include <yy_object.h>
+#include <random>
+#include <cstdio>
+
+// 测试 用: 条件不成立 则 打印位置 并 返回 行号( 与 库内 失败返回 __LINE__ 的习惯一致 )
+#define YY_CHECK(c) do { if (!(c)) { printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #c); return __LINE__; } } while (0)
+
+namespace yy_tests {
+
+	// 执行 f 共 times 次, 返回 最快一次 的 毫秒数( 单核 / 有干扰 的机器上 取最小值 比 取平均 稳定 )
+	template<typename F>
+	double BestMs(int const& times, F&& f) {
+		double r = 1e100;
+		for (int i = 0; i < times; ++i) {
+			auto t = std::chrono::steady_clock::now();
+			f();
+			r = std::min(r, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t).count());
+		}
+		return r;
+	}
+
+	inline volatile uint64_t keepAliveSink = 0;
+
+	// 防止 计算结果 被 优化掉
+	inline void KeepAlive(uint64_t const& v) {
+		keepAliveSink = keepAliveSink + v;
+	}
+}
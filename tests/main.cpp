@@ -1,7 +1,39 @@
-﻿#include <yy_object.h>
+﻿#include "bench_grow.h"
+#include "bench_varint.h"
+#include "bench_bswap.h"
+#include "bench_parallel.h"
+#include "bench_visit.h"
+#include "bench_dispatch.h"
+#include "test_data.h"
+#include "test_buffers.h"
+#include "test_varint.h"
+#include "test_containers.h"
+#include "test_object_reader.h"
+#include "test_object.h"
+#include "test_parallel.h"
 
-int main() {
-	// todo
+int main(int argc, char** argv) {
+	int failed = 0;
+	failed += yy_tests::TestData() != 0;
+	failed += yy_tests::TestBuffers() != 0;
+	failed += yy_tests::TestVarInt() != 0;
+	failed += yy_tests::TestContainers() != 0;
+	failed += yy_tests::TestObjectReader() != 0;
+	failed += yy_tests::TestObject() != 0;
+	failed += yy_tests::TestParallelWrite() != 0;
 
+	if (argc > 1 && std::string_view(argv[1]) == "bench") {
+		yy_tests::BenchGrow();
+		yy_tests::BenchVarInt();
+		yy_tests::BenchBSwap();
+		yy_tests::BenchVisit();
+		yy_tests::BenchParallelWrite();
+		yy_tests::BenchDispatch();
+	}
+	if (failed) {
+		printf("%d test(s) failed\n", failed);
+		return 1;
+	}
+	printf("ok\n");
 	return 0;
 }
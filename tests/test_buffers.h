@@ -0,0 +1,322 @@
+﻿#pragma once
+#include "test_data.h"
+#include <yy_buffer_ring.h>
+#include <yy_buffer_chain.h>
+#include <yy_buffer_mapped.h>
+#include <yy_buffer_stream.h>
+#include <filesystem>
+#include <deque>
+
+namespace yy_tests {
+
+	// DataRing 随机测试: 与 std::deque 对照. 两种写法( WriteBuf, GetWriteSpans + Commit ), 随机 扩容, 读 随机长度 的 包
+	// 回绕 后 LeftData_r / LeftSpans / ReadBufAt / ReadFixedAt 都须 与 对照 一致; 未回绕 时 LeftData_r 不复制
+	inline int TestDataRing() {
+		std::mt19937_64 rnd(3);
+		yy::DataRing ring(16);
+		std::deque<uint8_t> ref;
+		yy::Data tmp;
+		uint8_t next = 0;
+		size_t wraps = 0;
+		for (int round = 0; round < 20000; ++round) {
+			if (rnd() % 2) {
+				std::vector<uint8_t> w(rnd() % 40);
+				for (auto& b : w) {
+					b = next++;
+				}
+				if (rnd() % 2) {
+					ring.WriteBuf(w.data(), w.size());
+				}
+				else {
+					if (rnd() % 8 == 0) {
+						ring.Reserve(ring.Len() + w.size() + rnd() % 64);
+					}
+					yy::Span ss[2];
+					auto n = ring.GetWriteSpans(ss);
+					YY_CHECK(n <= 2 && (!n || ss[0].len + (n == 2 ? ss[1].len : 0) == ring.FreeLen()));
+					size_t done = 0;
+					for (size_t k = 0; k < n && done < w.size(); ++k) {
+						auto m = std::min(ss[k].len, w.size() - done);
+						memcpy(ss[k].buf, w.data() + done, m);
+						done += m;
+					}
+					ring.Commit(done);
+					w.resize(done);												// 可写空间 不足 时 只写了 一部分
+				}
+				ref.insert(ref.end(), w.begin(), w.end());
+			}
+			YY_CHECK(ring.Len() == ref.size() && (ring.cap & (ring.cap - 1)) == 0);
+			if (!ref.empty()) {
+				auto siz = 1 + rnd() % ref.size();
+				auto dr = ring.LeftData_r(siz, tmp);
+				YY_CHECK(dr.len == siz && !dr.offset);
+				for (size_t i = 0; i < siz; ++i) {
+					YY_CHECK(dr.buf[i] == ref[i]);
+				}
+				auto idx = ring.head & (ring.cap - 1);
+				auto wrapped = idx + siz > ring.cap;
+				wraps += wrapped;
+				YY_CHECK(wrapped ? dr.buf == tmp.buf : dr.buf == ring.buf + idx);
+
+				yy::Span ss[2];
+				auto n = ring.LeftSpans(ss);
+				YY_CHECK(n == 1 + (idx + ref.size() > ring.cap));
+				YY_CHECK(ss[0].len + (n == 2 ? ss[1].len : 0) == ref.size());
+				YY_CHECK(ss[0].buf[0] == ref[0] && (n == 1 || ss[1].buf[0] == ref[ss[0].len]));
+
+				if (ref.size() >= 4) {
+					uint32_t v, e;
+					auto at = rnd() % (ref.size() - 3);
+					YY_CHECK(!ring.ReadFixedAt(at, v));
+					uint8_t eb[4] = { ref[at], ref[at + 1], ref[at + 2], ref[at + 3] };
+					memcpy(&e, eb, 4);
+					YY_CHECK(v == e);
+				}
+				std::vector<uint8_t> all(ref.size());
+				YY_CHECK(ring.ReadBufAt(1, all.data(), ref.size()));		// 越界 失败
+				YY_CHECK(!ring.ReadBufAt(0, all.data(), ref.size()) && std::equal(all.begin(), all.end(), ref.begin()));
+				auto rm = rnd() % (siz + 1);
+				ring.RemoveFront(rm);
+				ref.erase(ref.begin(), ref.begin() + rm);
+			}
+		}
+		YY_CHECK(wraps > 100);
+		ring.Clear(true);
+		YY_CHECK(!ring.buf && !ring.cap && !ring.Len());
+		return 0;
+	}
+
+	// DataChain: 随机长度 写入( 含 超过 blockSize 的 ), 导出的 iovec 依次拼接 与 写入一个 Data 的 字节 相同, 已封存的块 不被复制
+	inline int TestDataChain() {
+		std::mt19937_64 rnd(4);
+		for (int round = 0; round < 50; ++round) {
+			yy::DataChain dc(64 + rnd() % 256);
+			yy::Data ref;
+			std::vector<uint8_t> w;
+			for (auto n = rnd() % 200; n; --n) {
+				w.resize(rnd() % 4 ? rnd() % 50 : rnd() % 1000);
+				for (auto& b : w) {
+					b = (uint8_t)rnd();
+				}
+				if (rnd() % 2) {
+					dc.WriteBuf(w.data(), w.size());
+					ref.WriteBuf(w.data(), w.size());
+				}
+				else {
+					auto v = rnd() >> (rnd() % 64);
+					dc.WriteVarInteger(v);
+					ref.WriteVarInteger(v);
+				}
+			}
+			YY_CHECK(dc.TotalLen() == ref.len);
+			for (auto& sp : dc.blocks.spans) {
+				YY_CHECK(sp.len);
+			}
+
+#ifdef _WIN32
+			using IoVec = WSABUF;
+			auto fill = [&](IoVec* tar, size_t siz, size_t skip) { return dc.FillWSABufs(tar, siz, skip); };
+			auto base = [](IoVec const& v) { return (void*)v.buf; };
+			auto len = [](IoVec const& v) { return (size_t)v.len; };
+#else
+			using IoVec = iovec;
+			auto fill = [&](IoVec* tar, size_t siz, size_t skip) { return dc.FillIovecs(tar, siz, skip); };
+			auto base = [](IoVec const& v) { return v.iov_base; };
+			auto len = [](IoVec const& v) { return v.iov_len; };
+#endif
+			std::vector<IoVec> iovs(dc.SpansCount());
+			YY_CHECK(fill(iovs.data(), iovs.size(), 0) == iovs.size());
+			size_t pos = 0;
+			for (auto& v : iovs) {
+				YY_CHECK(pos + len(v) <= ref.len && !memcmp(base(v), ref.buf + pos, len(v)));
+				pos += len(v);
+			}
+			YY_CHECK(pos == ref.len);
+			if (iovs.size() > 1) {											// skip 及 容量 不足
+				IoVec v[1];
+				YY_CHECK(fill(v, 1, 1) == 1 && base(v[0]) == base(iovs[1]) && len(v[0]) == len(iovs[1]));
+			}
+			YY_CHECK(dc.ToData() == ref);
+			dc.Clear();
+			YY_CHECK(!dc.TotalLen() && !dc.SpansCount());
+		}
+		return 0;
+	}
+
+	// MappedData_rw: 写入 过程中 多次 扩大文件 并 重新映射, Close 按 实际长度 截短; 再打开 可 追加. MappedData 读回 一致
+	inline int TestMappedData() {
+		auto path = (std::filesystem::temp_directory_path() / "yy_tests_mapped.bin").string();
+		yy::Data ref;
+		std::mt19937_64 rnd(5);
+		{
+			yy::MappedData_rw md;
+			YY_CHECK(!md.Open(path.c_str(), true));
+			YY_CHECK(!md.len);
+			size_t grows = 0, lastCap = 0;
+			while (ref.len < 3 * 1024 * 1024 + 123) {
+				auto v = rnd();
+				md.WriteFixed(v);
+				md.WriteVarInteger(v >> (v % 64));
+				ref.WriteFixed(v);
+				ref.WriteVarInteger(v >> (v % 64));
+				if (md.cap != lastCap) {
+					lastCap = md.cap;
+					++grows;
+				}
+			}
+			YY_CHECK(grows > 1 && md == ref);
+			YY_CHECK(!md.Flush());
+			YY_CHECK(!md.Close());
+		}
+		YY_CHECK(std::filesystem::file_size(path) == ref.len);
+		{
+			yy::MappedData md;
+			YY_CHECK(!md.Open(path.c_str()));
+			YY_CHECK(md.len == ref.len && !memcmp(md.buf, ref.buf, ref.len));
+			md.Advise(true);
+		}
+		{
+			yy::MappedData_rw md;											// 不截断 打开: 映射 已有内容, 继续 追加
+			YY_CHECK(!md.Open(path.c_str()));
+			YY_CHECK(md.len == ref.len);
+			md.WriteBuf("tail", 4);
+			ref.WriteBuf("tail", 4);
+		}																	// 析构 即 Close
+		YY_CHECK(std::filesystem::file_size(path) == ref.len);
+		{
+			yy::MappedData md;
+			YY_CHECK(!md.Open(path.c_str()));
+			YY_CHECK(md.len == ref.len && !memcmp(md.buf, ref.buf, ref.len));
+		}
+		{
+			yy::MappedData_rw md;											// 截断 为 空
+			YY_CHECK(!md.Open(path.c_str(), true));
+		}
+		{
+			yy::MappedData md;
+			YY_CHECK(!md.Open(path.c_str()) && !md.len && !md.buf);
+		}
+		std::filesystem::remove(path);
+		yy::MappedData md;
+		YY_CHECK(md.Open(path.c_str()));									// 文件 不存在
+		return 0;
+	}
+
+	// 同样的 随机写入 分别 写到 DataStream 与 普通 Data
+	template<typename D>
+	void WriteStreamOps(D& d, std::mt19937_64 rnd, yy::object_handler& om, size_t const& maxBuf) {
+		std::vector<uint8_t> bs;
+		for (int i = 0; i < 300; ++i) {
+			switch (rnd() % 6) {
+			case 0: d.WriteFixed((uint8_t)rnd()); break;
+			case 1: d.WriteVarInteger(rnd() >> (rnd() % 64)); break;
+			case 2: d.WriteFixedBE((uint32_t)rnd()); break;
+			case 3:
+				bs.resize(1 + rnd() % maxBuf);
+				for (auto& c : bs) {
+					c = (uint8_t)rnd();
+				}
+				d.WriteBuf(bs.data(), bs.size());
+				break;
+			case 4: d.Write(std::string(rnd() % maxBuf, 's')); break;
+			default: om.WriteTo(d, std::make_tuple(std::vector<int64_t>(rnd() % 50, (int64_t)rnd()), std::to_string(rnd()))); break;
+			}
+		}
+	}
+
+	// DataStream 随机测试: 暂存区 各种大小( 含 比单次写入 小的 ), 送出的字节 与 写入 普通 Data 的 完全相同
+	// 送出 只在 暂存区 写不下 及 Flush 时 发生, 除 单次 超大写入 外 每次 不超过 暂存区 大小, 之后 暂存区 缩回 原大小
+	// sink 出错 后 不再调用, Flush / Error 返回 首个错误. 另测 FILE* 与 文件描述符
+	inline int TestDataStream() {
+		std::mt19937_64 rnd(18);
+		yy::object_handler om;
+		for (int round = 0; round < 200; ++round) {
+			auto stageSize = (size_t)(1 + rnd() % (round % 4 ? 64 : 4096));
+			auto maxBuf = (size_t)(1 + rnd() % 300);
+			auto seed = rnd();
+			std::vector<uint8_t> out;
+			size_t calls = 0, failAt = round % 5 ? SIZE_MAX : (size_t)(rnd() % 10);
+			yy::DataStream ds([&](uint8_t const* buf, size_t len) {
+				if (calls++ == failAt) return __LINE__;
+				out.insert(out.end(), buf, buf + len);
+				return 0;
+			}, stageSize);
+			yy::Data ref;
+			WriteStreamOps(ref, std::mt19937_64(seed), om, maxBuf);
+			WriteStreamOps(ds, std::mt19937_64(seed), om, maxBuf);
+			YY_CHECK(ds.TotalLen() == ref.len && ds.len <= ds.cap);
+
+			auto r = ds.Flush();
+			YY_CHECK(ds.len == 0 && ds.TotalLen() == ref.len && ds.stage.sentLen == ref.len);
+			if (failAt < calls) {
+				YY_CHECK(r && r == ds.Error() && calls == failAt + 1);		// 出错后 不再调用 sink
+				YY_CHECK(out.size() < ref.len && (out.empty() || !memcmp(out.data(), ref.buf, out.size())));
+			}
+			else {
+				YY_CHECK(!r && !ds.Error());
+				YY_CHECK(out.size() == ref.len && !memcmp(out.data(), ref.buf, ref.len));
+				auto c = calls;
+				YY_CHECK(!ds.Flush() && calls == c);						// 暂存区 空 则 不调用 sink
+			}
+		}
+
+		// 每次 送出 的长度: 暂存区 写满 才送出; 单次 写入 超过 暂存区 时 整块 送出, 之后 暂存区 缩回 原大小
+		{
+			std::vector<size_t> sends;
+			yy::DataStream ds([&](uint8_t const*, size_t len) {
+				sends.push_back(len);
+				return 0;
+			}, 16);
+			for (int i = 0; i < 20; ++i) {
+				ds.WriteFixed((uint8_t)i);
+			}
+			YY_CHECK(sends.size() == 1 && sends[0] == 16 && ds.len == 4 && ds.cap == 16);
+			std::string big(100, 'b');
+			ds.WriteBuf(big.data(), big.size());
+			YY_CHECK(sends.size() == 2 && sends[1] == 4 && ds.len == 100 && ds.cap == 128);
+			for (int i = 0; i < 28; ++i) {
+				ds.WriteFixed((uint8_t)i);
+			}
+			YY_CHECK(sends.size() == 2 && ds.len == 128);
+			ds.WriteFixed((uint8_t)1);
+			YY_CHECK(sends.size() == 3 && sends[2] == 128 && ds.len == 1 && ds.cap == 16);
+			YY_CHECK(!ds.Flush() && sends.size() == 4 && sends[3] == 1 && ds.TotalLen() == 149);
+			YY_CHECK(!ds.Flush() && sends.size() == 4);
+		}
+
+		// FILE* 与 文件描述符
+		for (int fd = 0; fd < 2; ++fd) {
+#ifdef _WIN32
+			if (fd) break;
+#endif
+			auto f = tmpfile();
+			YY_CHECK(f);
+			yy::Data ref;
+			WriteStreamOps(ref, std::mt19937_64(fd), om, 1000);
+			{
+#ifdef _WIN32
+				yy::DataStream ds(f, 100);
+#else
+				auto ds = fd ? yy::DataStream(fileno(f), 100) : yy::DataStream(f, 100);
+#endif
+				WriteStreamOps(ds, std::mt19937_64(fd), om, 1000);
+				YY_CHECK(!ds.Flush());
+			}
+			fflush(f);
+			rewind(f);
+			std::vector<uint8_t> got(ref.len + 1);
+			auto n = fread(got.data(), 1, got.size(), f);
+			fclose(f);
+			YY_CHECK(n == ref.len && !memcmp(got.data(), ref.buf, ref.len));
+		}
+		return 0;
+	}
+
+	inline int TestBuffers() {
+		if (int r = TestDataRing()) return r;
+		if (int r = TestDataChain()) return r;
+		if (int r = TestMappedData()) return r;
+		if (int r = TestDataStream()) return r;
+		return 0;
+	}
+}
@@ -0,0 +1,223 @@
+﻿#pragma once
+#include "test_varint.h"
+
+namespace yy_tests {
+
+	// 参考编码: 个数 + 逐个 WriteVarInteger( 1 字节类型 为 定长 )
+	template<typename C>
+	void WriteReference(yy::Data& d, C const& c) {
+		d.WriteVarInteger(c.size());
+		for (auto&& v : c) {
+			if constexpr (sizeof(v) == 1) {
+				d.WriteFixed(v);
+			}
+			else {
+				d.WriteVarInteger(v);
+			}
+		}
+	}
+
+	// 写入前 先把 d 填到 离 cap 只差 几个字节( 个数 写得下, 元素 写不下 ), 预留 不足 而 免检查写入 的话 ASan 可发现 越界写
+	inline void FillToCap(yy::Data& d, std::mt19937_64& rnd) {
+		d.Clear(true);
+		d.Reserve(16 + rnd() % 300);
+		auto len = d.cap - rnd() % 12;
+		while (d.len < len) {
+			d.buf[d.len++] = (uint8_t)rnd();
+		}
+	}
+
+	// 整数容器 经 DataFuncs 及 object_handler 写入: 字节 与 参考编码 一致, 且 能 读回
+	template<typename C>
+	int TestIntegerContainer(std::mt19937_64& rnd, yy::object_handler& om) {
+		using T = typename C::value_type;
+		for (int round = 0; round < 200; ++round) {
+			auto n = (size_t)(rnd() % (round % 10 ? 100 : 5000));
+			C c;
+			for (size_t i = 0; i < n; ++i) {
+				auto v = rnd() % 4 ? RandomInteger<T>(rnd) : (rnd() & 1 ? std::numeric_limits<T>::min() : std::numeric_limits<T>::max());
+				if constexpr (requires { c.push_back(v); }) {
+					c.push_back(v);
+				}
+				else {
+					c.insert(v);
+				}
+			}
+			yy::Data ref;
+			WriteReference(ref, c);
+
+			yy::Data d;
+			size_t prefix;
+			if constexpr (yy::IsVector_v<C> || yy::IsSetSeries_v<C>) {		// DataFuncs 不支持 deque
+				FillToCap(d, rnd);
+				prefix = d.len;
+				d.Write(c);
+				YY_CHECK(d.len - prefix == ref.len && !memcmp(d.buf + prefix, ref.buf, ref.len));
+				C c2;
+				yy::Data_r dr(d.buf, d.len, prefix);
+				YY_CHECK(!dr.Read(c2));
+				YY_CHECK(c2 == c && dr.offset == d.len);
+			}
+
+			FillToCap(d, rnd);
+			prefix = d.len;
+			om.WriteTo(d, c);
+			YY_CHECK(d.len - prefix == ref.len && !memcmp(d.buf + prefix, ref.buf, ref.len));
+			{
+				C c2;
+				yy::Data_r dr(d.buf, d.len, prefix);
+				YY_CHECK(!om.ReadFrom(dr, c2));
+				YY_CHECK(c2 == c && dr.offset == d.len);
+			}
+		}
+		return 0;
+	}
+
+	template<typename T>
+	int TestIntegerContainers(std::mt19937_64& rnd, yy::object_handler& om) {
+		if (int r = TestIntegerContainer<std::vector<T>>(rnd, om)) return r;
+		if (int r = TestIntegerContainer<std::deque<T>>(rnd, om)) return r;
+		if (int r = TestIntegerContainer<std::set<T>>(rnd, om)) return r;
+		if (int r = TestIntegerContainer<std::unordered_set<T>>(rnd, om)) return r;
+		return 0;
+	}
+
+	// EncodedVector 的 随机数据: 个数 覆盖 空, 不足一块( 128 ) 的 尾部, 整块 及 整块 + 尾部. 值 的分布 按 mode 选:
+	// 全范围随机, 常数( ForBitPack 位宽 0 ), 含 min 与 max( 位宽 为 类型位数 ), 递增( 差值小 ), 小幅波动
+	template<typename T>
+	std::vector<T> RandomEncodedValues(std::mt19937_64& rnd, int const& mode) {
+		using U = std::make_unsigned_t<T>;
+		size_t n;
+		switch (rnd() % 4) {
+		case 0: n = rnd() % 8; break;
+		case 1: n = rnd() % 128; break;
+		case 2: n = 128 * (1 + rnd() % 3); break;
+		default: n = 128 * (rnd() % 4) + rnd() % 128; break;
+		}
+		std::vector<T> vs(n);
+		auto c = RandomInteger<T>(rnd);
+		for (size_t i = 0; i < n; ++i) {
+			switch (mode) {
+			case 0: vs[i] = RandomInteger<T>(rnd); break;
+			case 1: vs[i] = c; break;
+			case 2: vs[i] = i % 2 ? std::numeric_limits<T>::min() : std::numeric_limits<T>::max(); break;
+			case 3: vs[i] = c = (T)U(U(c) + U(rnd() % 100)); break;
+			default: vs[i] = (T)U(U(c) + U(rnd() % 7) - U(3)); break;
+			}
+		}
+		return vs;
+	}
+
+	// 解析 ForBitPack 编码 各整块 的 位宽 字节
+	template<typename T>
+	int ForBitPackWidths(yy::Data const& d, std::vector<uint8_t>& ws) {
+		yy::Data_r dr(d);
+		size_t n = 0;
+		if (int r = dr.Read(n)) return r;
+		ws.clear();
+		for (; n >= 128; n -= 128) {
+			T mi;
+			uint8_t b;
+			if (int r = dr.ReadVarInteger(mi)) return r;
+			if (int r = dr.ReadFixed(b)) return r;
+			ws.push_back(b);
+			dr.offset += 16 * b;
+		}
+		return 0;
+	}
+
+	// EncodedVector 各编码 读写: 能 读回( DataFuncs 与 object_handler ), ComputeSize 精确, 截断 的 输入 都读失败
+	// Varint 与 std::vector 默认格式 相同, FixedLE 为 定长小尾 原样. ForBitPack 常数块 位宽 0, 含 min 与 max 的块 位宽 为 类型位数
+	// SIMD 与 标量 实现 各自测试: 另以 -DYY_NO_SIMD 编译 可测 标量 路径
+	template<typename T, yy::IntEncodings E>
+	int TestEncodedVector(std::mt19937_64& rnd, yy::object_handler& om) {
+		using EV = yy::EncodedVector<T, E>;
+		std::vector<uint8_t> ws;
+		for (int round = 0; round < 100; ++round) {
+			auto mode = round % 5;
+			EV ev(RandomEncodedValues<T>(rnd, mode));
+			yy::Data d;
+			d.Write(ev);
+			YY_CHECK(om.ComputeSize(ev) == d.len);
+
+			if constexpr (E == yy::IntEncodings::Varint) {
+				yy::Data ref;
+				ref.Write((std::vector<T> const&)ev);
+				YY_CHECK(d == ref);
+			}
+			else if constexpr (E == yy::IntEncodings::FixedLE) {
+				yy::Data ref;
+				ref.WriteVarInteger(ev.size());
+				for (auto v : ev) {
+					ref.WriteFixed(v);
+				}
+				YY_CHECK(d == ref);
+			}
+			else if constexpr (E == yy::IntEncodings::ForBitPack) {
+				YY_CHECK(!ForBitPackWidths<T>(d, ws) && ws.size() == ev.size() / 128);
+				for (auto b : ws) {
+					if (mode == 1) YY_CHECK(b == 0);
+					if (mode == 2) YY_CHECK(b == sizeof(T) * 8);
+				}
+			}
+
+			{
+				std::vector<uint8_t> exact(d.buf, d.buf + d.len);
+				EV ev2;
+				yy::Data_r dr(exact.data(), exact.size());
+				YY_CHECK(!dr.Read(ev2) && ev2 == ev && dr.offset == exact.size());
+			}
+			{
+				yy::Data d2;
+				om.WriteTo(d2, ev);
+				YY_CHECK(d2 == d);
+				EV ev2;
+				yy::Data_r dr(d2);
+				YY_CHECK(!om.ReadFrom(dr, ev2) && ev2 == ev && dr.offset == d2.len);
+			}
+
+			// 截断: 短数据 逐个长度, 长的 随机抽取. 复制到 恰好长度 的堆内存, 以便 ASan 发现 越界读
+			for (int k = 0; k < 10 && d.len; ++k) {
+				auto cut = d.len <= 10 ? (size_t)k : (size_t)(rnd() % d.len);
+				if (cut >= d.len) break;
+				std::vector<uint8_t> exact(d.buf, d.buf + cut);
+				EV ev2;
+				yy::Data_r dr(exact.data(), exact.size());
+				YY_CHECK(dr.Read(ev2));
+			}
+		}
+		return 0;
+	}
+
+	template<typename T>
+	int TestEncodedVectors(std::mt19937_64& rnd, yy::object_handler& om) {
+		if (int r = TestEncodedVector<T, yy::IntEncodings::Varint>(rnd, om)) return r;
+		if (int r = TestEncodedVector<T, yy::IntEncodings::DeltaZigZag>(rnd, om)) return r;
+		if (int r = TestEncodedVector<T, yy::IntEncodings::ForBitPack>(rnd, om)) return r;
+		if (int r = TestEncodedVector<T, yy::IntEncodings::FixedLE>(rnd, om)) return r;
+		return 0;
+	}
+
+	// 容器 预留 回归 随机测试( 元素类型 x 容器 x 随机个数 x 已有数据 )
+	inline int TestContainers() {
+		std::mt19937_64 rnd(2024);
+		yy::object_handler om;
+		if (int r = TestIntegerContainers<int8_t>(rnd, om)) return r;
+		if (int r = TestIntegerContainers<uint8_t>(rnd, om)) return r;
+		if (int r = TestIntegerContainers<int16_t>(rnd, om)) return r;
+		if (int r = TestIntegerContainers<uint16_t>(rnd, om)) return r;
+		if (int r = TestIntegerContainers<int32_t>(rnd, om)) return r;
+		if (int r = TestIntegerContainers<uint32_t>(rnd, om)) return r;
+		if (int r = TestIntegerContainers<int64_t>(rnd, om)) return r;
+		if (int r = TestIntegerContainers<uint64_t>(rnd, om)) return r;
+		if (int r = TestEncodedVectors<int8_t>(rnd, om)) return r;
+		if (int r = TestEncodedVectors<uint8_t>(rnd, om)) return r;
+		if (int r = TestEncodedVectors<int16_t>(rnd, om)) return r;
+		if (int r = TestEncodedVectors<uint16_t>(rnd, om)) return r;
+		if (int r = TestEncodedVectors<int32_t>(rnd, om)) return r;
+		if (int r = TestEncodedVectors<uint32_t>(rnd, om)) return r;
+		if (int r = TestEncodedVectors<int64_t>(rnd, om)) return r;
+		if (int r = TestEncodedVectors<uint64_t>(rnd, om)) return r;
+		return 0;
+	}
+}
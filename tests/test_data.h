@@ -0,0 +1,244 @@
+﻿#pragma once
+#include "helpers.h"
+
+namespace yy_tests {
+
+	// 走 malloc / free 并 计数 的 分配器
+	struct CountingAllocator : yy::DataAllocator {
+		size_t allocs = 0, frees = 0;
+
+		void* Alloc(size_t const& siz) override {
+			++allocs;
+			return malloc(siz);
+		}
+
+		void Free(void* const& p, size_t const& /*siz*/) override {
+			++frees;
+			free(p);
+		}
+	};
+
+	// 从 一段内存 顺序切分 的 分配器( 类似 无块头 的 slab ): 切出的 buf 可能 恰好 紧跟在 某个 Data 对象 后面
+	struct SlotAllocator : yy::DataAllocator {
+		uint8_t* next = nullptr;
+		size_t allocs = 0, frees = 0;
+
+		void* Alloc(size_t const& siz) override {
+			++allocs;
+			auto p = next;
+			next += siz;
+			return p;
+		}
+
+		void Free(void* const& /*p*/, size_t const& /*siz*/) override {
+			++frees;
+		}
+	};
+
+	// 写入 n 个 按下标 递增 的字节, 再检查 全部内容
+	inline int WriteCheck(yy::Data& d, size_t const& n) {
+		auto from = d.len;
+		for (size_t i = 0; i < n; ++i) {
+			d.WriteFixed((uint8_t)(from + i));
+		}
+		for (size_t i = 0; i < d.len; ++i) {
+			YY_CHECK(d.buf[i] == (uint8_t)i);
+		}
+		return 0;
+	}
+
+	// 自定义分配器: 扩容( 默认 Realloc ) 保留数据, move 时 allocator 跟随 buf, 块 都被归还
+	inline int TestDataAllocator() {
+		CountingAllocator ca;
+		{
+			yy::Data d(ca, 10);
+			YY_CHECK(d.cap >= 10 && ca.allocs == 1);
+			if (int r = WriteCheck(d, 1000)) return r;
+			YY_CHECK(ca.allocs > 1 && ca.frees == ca.allocs - 1);
+			yy::Data d2(std::move(d));
+			YY_CHECK(d2.allocator == &ca && d2.len == 1000 && !d.buf && !d.allocator);
+			yy::Data d3;
+			d3 = std::move(d2);
+			YY_CHECK(d3.allocator == &ca && d3.len == 1000 && !d2.buf);
+		}
+		YY_CHECK(ca.allocs == ca.frees);
+		return 0;
+	}
+
+	// DataArena: 块内 顺序切分 且 16 字节对齐, 用尽 追加块, Reset 合并为 一块 足够大的
+	inline int TestDataArena() {
+		yy::DataArena a(1024);
+		std::vector<yy::Data> ds;
+		ds.reserve(20);
+		for (int i = 0; i < 20; ++i) {
+			ds.emplace_back(a, 100);
+			YY_CHECK(((size_t)ds.back().buf & 15) == 0);
+			if (int r = WriteCheck(ds.back(), 100)) return r;
+		}
+		YY_CHECK(a.chunks.size() > 1);
+		for (auto& d : ds) {												// 互不覆盖
+			for (size_t i = 0; i < d.len; ++i) {
+				YY_CHECK(d.buf[i] == (uint8_t)i);
+			}
+		}
+		size_t total = 0;
+		for (auto& c : a.chunks) {
+			total += c.second;
+		}
+		ds.clear();
+		a.Reset();
+		YY_CHECK(a.chunks.size() == 1 && a.chunks[0].second >= total && !a.chunkLen);
+		for (int i = 0; i < 20; ++i) {										// 同样的用量 不再追加块
+			ds.emplace_back(a, 100);
+		}
+		YY_CHECK(a.chunks.size() == 1);
+		return 0;
+	}
+
+	// DataPool: 释放的块 按 容量级别 缓存 并 复用, 每级 最多 maxBlocksPerClass 块, Trim 全部释放
+	inline int TestDataPool() {
+		yy::DataPool pool;
+		pool.maxBlocksPerClass = 2;
+		uint8_t* p;
+		{
+			yy::Data d(pool, 100);
+			p = d.buf;
+		}
+		YY_CHECK(pool.blocks[yy::Calc2n(128)].size() == 1);
+		{
+			yy::Data d(pool, 120);											// 同级 复用
+			YY_CHECK(d.buf == p && pool.blocks[yy::Calc2n(128)].empty());
+			yy::Data d2(pool, 1000);										// 别的级 新分配
+			YY_CHECK(d2.buf != p);
+		}
+		{
+			yy::Data d1(pool, 100), d2(pool, 100), d3(pool, 100);
+		}
+		YY_CHECK(pool.blocks[yy::Calc2n(128)].size() == 2 && pool.blocks[yy::Calc2n(1024)].size() == 1);
+		pool.Trim();
+		for (auto& bs : pool.blocks) {
+			YY_CHECK(bs.empty());
+		}
+		return 0;
+	}
+
+	// 预缺页 策略: None 不碰内存, Touch 每页 首字节 写 0, 其余不变
+	inline int TestDataPrefault() {
+		std::vector<uint8_t> m(4096 * 3 + 100, 0xff);
+		yy::DataPrefault(m.data(), m.size(), yy::DataPrefaults::None);
+		YY_CHECK(std::count(m.begin(), m.end(), 0) == 0);
+		yy::DataPrefault(m.data(), m.size(), yy::DataPrefaults::Touch);
+		for (size_t i = 0; i < m.size(); ++i) {
+			YY_CHECK(m[i] == (i % 4096 ? 0xff : 0));
+		}
+		return 0;
+	}
+
+	// DataPageAllocator: 小块 走 malloc, 达到阈值 的 块 按 2MB 对齐; Data 从 小块 长到 大块 再 继续长( mremap ), 内容 不变
+	inline int TestDataPageAllocator() {
+		yy::DataPageAllocator pa;
+		pa.hugePageThreshold = 1024 * 1024;
+		pa.prefault = yy::DataPrefaults::Touch;
+		auto p = pa.Alloc(4096);
+		YY_CHECK(p && !pa.IsLarge(4096));
+		pa.Free(p, 4096);
+
+		yy::Data d(pa, 1000);
+		std::vector<uint8_t> chunk(65536);
+		for (size_t i = 0; i < chunk.size(); ++i) {
+			chunk[i] = (uint8_t)(i * 7);
+		}
+		bool small = false, large = false;
+		while (d.len < 6 * 1024 * 1024) {
+			d.WriteBuf(chunk.data(), chunk.size());
+			if (pa.IsLarge(d.cap)) {
+				YY_CHECK(((size_t)d.buf & (yy::DataPageAllocator::hugePageSize - 1)) == 0);
+				large = true;
+			}
+			else {
+				small = true;
+			}
+		}
+		YY_CHECK(small && large);
+		for (size_t i = 0; i < d.len; i += chunk.size()) {
+			YY_CHECK(!memcmp(d.buf + i, chunk.data(), chunk.size()));
+		}
+		return 0;
+	}
+
+	// buf 紧跟在 Data 对象 后面 不等于 内嵌空间: 扩容 / 释放 照常 归还, move 照常 移交
+	inline int TestAdjacentBuf() {
+		alignas(16) static uint8_t mem[sizeof(yy::Data) + 4096];
+		SlotAllocator a;
+		a.next = mem + sizeof(yy::Data);
+		auto d = new (mem) yy::Data(a);
+		d->WriteBuf("0123456789", 10);
+		YY_CHECK(d->buf == mem + sizeof(yy::Data));
+		uint8_t tail[40]{};
+		d->WriteBuf(tail, 40);												// 数据量过半, 走 Realloc
+		YY_CHECK(a.allocs == 2 && a.frees == 1);
+		YY_CHECK(!memcmp(d->buf, "0123456789", 10));
+		yy::Data d2(std::move(*d));
+		YY_CHECK(!d->buf && d2.allocator == &a && d2.len == 50);
+		d2.Clear(true);
+		d->~Data_rw();
+		YY_CHECK(a.allocs == a.frees);
+
+		a.next = mem + sizeof(yy::Data);
+		d = new (mem) yy::Data(a, 16);
+		YY_CHECK(d->buf == mem + sizeof(yy::Data));
+		d->~Data_rw();
+		YY_CHECK(a.allocs == a.frees);
+		return 0;
+	}
+
+	// SmallData: 内嵌空间 写满 后 转为 堆内存, 复制 / move 后 内容不变, 堆内存 都被归还
+	inline int TestSmallData() {
+		CountingAllocator ca;
+		std::vector<uint8_t> bytes(100);
+		for (size_t i = 0; i < bytes.size(); ++i) {
+			bytes[i] = (uint8_t)i;
+		}
+		{
+			yy::SmallData<16> s;
+			s.Heap(&ca);
+			s.WriteBuf(bytes.data(), 16);
+			YY_CHECK(s.buf == s.inlineBuf && !ca.allocs);
+			s.WriteBuf(bytes.data() + 16, 84);
+			YY_CHECK(s.buf != s.inlineBuf && ca.allocs == 1 && s.len == 100 && !memcmp(s.buf, bytes.data(), 100));
+
+			yy::SmallData<16> c(s);											// 复制 走 自己的 heap( malloc )
+			YY_CHECK(c.len == 100 && !memcmp(c.buf, bytes.data(), 100) && ca.allocs == 1);
+
+			auto p = s.buf;
+			yy::SmallData<16> m(std::move(s));								// 堆内存 连同 heap 挪走
+			YY_CHECK(m.buf == p && m.inl.heap == &ca && s.buf == s.inlineBuf && !s.len);
+			s.WriteBuf(bytes.data(), 5);
+			m = std::move(s);												// 内嵌数据 复制到 已有的 堆内存
+			YY_CHECK(m.buf == p && m.len == 5 && !memcmp(m.buf, bytes.data(), 5) && !s.len && !ca.frees);
+			m.Clear(true);
+			YY_CHECK(m.buf == m.inlineBuf && ca.frees == 1);
+
+			yy::Data d(std::move((yy::Data&)c));							// 以 Data 身份 move: 复制, 源 不变
+			YY_CHECK(d.len == 100 && !memcmp(d.buf, bytes.data(), 100) && c.len == 100 && d.buf != c.buf);
+
+			c.Clear(true);
+			YY_CHECK(c.buf == c.inlineBuf && c.cap == 16);
+			c.WriteBuf(bytes.data(), 3);
+			YY_CHECK(c.buf == c.inlineBuf);
+		}
+		YY_CHECK(ca.allocs == ca.frees);
+		return 0;
+	}
+
+	inline int TestData() {
+		if (int r = TestDataAllocator()) return r;
+		if (int r = TestDataArena()) return r;
+		if (int r = TestDataPool()) return r;
+		if (int r = TestDataPrefault()) return r;
+		if (int r = TestDataPageAllocator()) return r;
+		if (int r = TestAdjacentBuf()) return r;
+		if (int r = TestSmallData()) return r;
+		return 0;
+	}
+}
@@ -0,0 +1,428 @@
+﻿#pragma once
+#include "helpers.h"
+
+namespace yy_tests {
+	struct Node;
+	struct BigNode;
+	struct Particle;
+
+	struct Vec3 {
+		float x, y, z;
+		int32_t id;
+		bool operator==(Vec3 const&) const = default;
+	};
+}
+
+template<> struct yy::IsRawLayout<yy_tests::Vec3> : std::true_type {};
+template<> struct yy::StringFuncs<yy_tests::Vec3, void> {
+	static inline void Append(std::string& s, yy_tests::Vec3 const& in) {
+		yy::Append(s, "[", in.x, ",", in.y, ",", in.z, ",", in.id, "]");
+	}
+};
+
+namespace yy {
+	template<>
+	struct type_id<yy_tests::Node> {
+		static const uint16_t value = 101;
+	};
+	template<>
+	struct type_id<yy_tests::BigNode> {
+		static const uint16_t value = 102;
+	};
+	template<>
+	struct type_id<yy_tests::Particle> {
+		static const uint16_t value = 103;
+	};
+}
+
+namespace yy_tests {
+
+	struct Node : yy::object {
+		int32_t id = 0;
+		std::string name;
+		std::vector<int32_t> vals;
+		yy::shared_ptr<Node> next;
+		yy::weak_ptr<Node> parent;
+		std::vector<yy::shared_ptr<Node>> kids;
+		YY_FIELDS(Node, yy::object, id, name, vals, next, parent, kids)
+	};
+
+	struct BigNode : Node {
+		double w = 1.5;
+		std::vector<std::string> tags;
+		YY_FIELDS(BigNode, Node, w, tags)
+	};
+
+	// 含 相邻 的 IsRawWire_v 成员( x ~ tag 合并为 一次 memcpy ), 及 不相邻 的( tag 与 w 间 有填充 )
+	struct Particle : yy::object {
+		float x = 0, y = 0;
+		Vec3 v{};
+		uint8_t tag = 0;
+		double w = 0;
+		int32_t id = 0;
+		std::string name;
+		YY_FIELDS(Particle, yy::object, x, y, v, tag, w, id, name)
+	};
+
+	using Graph = std::vector<yy::shared_ptr<Node>>;
+
+	// 随机 共享图: next / kids 只指向 下标更大的 节点( 无环, 不泄漏 ), parent 为 weak 可指向任意节点. 含 空指针 与 派生类
+	inline Graph MakeGraph(std::mt19937_64& rnd, size_t const& n) {
+		Graph g(n);
+		for (size_t i = 0; i < n; ++i) {
+			if (rnd() % 3 == 0) {
+				auto o = yy::Make<BigNode>();
+				o->w = (double)rnd() / 7;
+				o->tags.resize(rnd() % 3, std::to_string(i));
+				g[i] = o;
+			}
+			else {
+				g[i] = yy::Make<Node>();
+			}
+			g[i]->id = (int32_t)i;
+			g[i]->name.assign(rnd() % 20, (char)('a' + i % 26));
+			g[i]->vals.resize(rnd() % 8, (int32_t)rnd());
+		}
+		for (size_t i = 0; i + 1 < n; ++i) {
+			if (rnd() % 2) {
+				g[i]->next = g[i + 1 + rnd() % (n - i - 1)];
+			}
+			for (auto k = rnd() % 4; k; --k) {
+				g[i]->kids.push_back(rnd() % 5 ? g[i + 1 + rnd() % (n - i - 1)] : yy::shared_ptr<Node>());
+			}
+			if (rnd() % 2) {
+				g[i]->parent = g[rnd() % n];
+			}
+		}
+		if (n && rnd() % 2) {
+			g.push_back(g[rnd() % n]);
+			g.push_back({});
+		}
+		return g;
+	}
+
+	// 共享图 读写: arena 模式 读出的图 再写 与 原字节 相同( 共享关系 与 类型 都保持 ), 且 新建的对象 都来自 arena
+	// 再读入 已有对象的 容器: 类型相同 则 原地复用, 不同 则 重建
+	inline int TestSharedGraphArena(std::mt19937_64& rnd, yy::object_handler& om) {
+		yy::DataArena arena(4096);
+		for (int round = 0; round < 50; ++round) {
+			Graph g2;
+			for (int pass = 0; pass < 2; ++pass) {
+				auto g = MakeGraph(rnd, rnd() % 100);
+				yy::Data d;
+				om.WriteTo(d, g);
+
+				std::vector<Node*> olds;
+				for (auto& o : g2) {
+					olds.push_back(o.pointer);
+				}
+				om.arena = &arena;
+				yy::Data_r dr(d.buf, d.len);
+				int r = om.ReadFrom(dr, g2);
+				om.arena = nullptr;
+				YY_CHECK(!r && dr.offset == d.len);
+
+				yy::Data d2;
+				om.WriteTo(d2, g2);
+				YY_CHECK(d2 == d);
+				for (size_t i = 0; i < g2.size(); ++i) {
+					if (!g2[i]) continue;
+					auto reused = i < olds.size() && g2[i].pointer == olds[i];
+					YY_CHECK(reused || (g2[i].GetHeader()->flags & yy::shared_ptr_object_header::FlagArena));
+					YY_CHECK(g2[i].GetHeader()->typeId == (g[i] ? g[i].GetHeader()->typeId : 0));
+				}
+			}
+			g2.clear();
+			arena.Reset();
+		}
+		return 0;
+	}
+
+	// 共享图 深复制( 含 池化 的类型 ): 复制品 写出的字节 与 原图 相同, 且 不与 原图 共用 任何对象
+	// 再复制到 已有对象的 容器( CloneTo ): 同上
+	inline int TestSharedGraphClone(std::mt19937_64& rnd, yy::object_handler& om) {
+		yy::object_pool::Enable<Node>();
+		Graph g2;
+		for (int round = 0; round < 100; ++round) {
+			auto g = MakeGraph(rnd, rnd() % 100);
+			yy::Data d;
+			om.WriteTo(d, g);
+			if (round % 2) {
+				om.CloneTo(g, g2);
+			}
+			else {
+				g2 = om.Clone(g);
+			}
+			yy::Data d2;
+			om.WriteTo(d2, g2);
+			YY_CHECK(d2 == d);
+			std::set<Node*> ps;
+			for (auto& o : g) {
+				ps.insert(o.pointer);
+			}
+			for (auto& o : g2) {
+				YY_CHECK(!o || !ps.count(o.pointer));
+			}
+		}
+		yy::object_pool::Enable<Node>(false);
+		return 0;
+	}
+
+	// SetDefaultValue 恢复 成员声明处 的 初始值( 含 父类 成员 ), 而非 一律 置 0 / 清空
+	inline int TestSetDefaultValue(yy::object_handler& om) {
+		auto o = yy::Make<BigNode>();
+		o->id = 7;
+		o->name = "x";
+		o->vals = { 1, 2 };
+		o->next = yy::Make<Node>();
+		o->parent = o->next;
+		o->w = 3;
+		o->tags = { "a" };
+		o->SetDefaultValue(om);
+		YY_CHECK(o->w == 1.5 && o->tags.empty());
+		YY_CHECK(o->id == 0 && o->name.empty() && o->vals.empty() && !o->next && !o->parent.Lock() && o->kids.empty());
+		return 0;
+	}
+
+	// 借用 解码: string_view / Span / Data_r 指向 源 内存( 不复制 ), 内容 与 写入的 std::string / Data 一致. 截断 的 输入 读失败
+	inline int TestBorrowedViews(std::mt19937_64& rnd, yy::object_handler& om) {
+		for (int round = 0; round < 100; ++round) {
+			std::string a(rnd() % 50, 'a');
+			yy::Data b;
+			for (auto n = rnd() % 300; n; --n) {
+				b.WriteFixed((uint8_t)rnd());
+			}
+			std::vector<std::string> c(rnd() % 5, std::string(rnd() % 10, 'c'));
+			yy::Data d;
+			om.WriteTo(d, std::make_tuple(a, b, c, b));
+
+			std::tuple<std::string_view, yy::Span, std::vector<std::string_view>, yy::Data_r> v;
+			yy::Data_r dr(d);
+			YY_CHECK(!om.ReadFrom(dr, v) && dr.offset == d.len);
+			auto in = [&](void const* p, size_t const& siz) {
+				return (uint8_t*)p >= d.buf && (uint8_t*)p + siz <= d.buf + d.len;
+			};
+			auto& [va, vb, vc, vd] = v;
+			YY_CHECK(va == a && (a.empty() || in(va.data(), va.size())));
+			YY_CHECK(vb.len == b.len && (!b.len || (in(vb.buf, vb.len) && !memcmp(vb.buf, b.buf, b.len))));
+			YY_CHECK(vc.size() == c.size());
+			for (size_t i = 0; i < c.size(); ++i) {
+				YY_CHECK(vc[i] == c[i] && (c[i].empty() || in(vc[i].data(), vc[i].size())));
+			}
+			YY_CHECK(vd.len == b.len && !vd.offset && (!b.len || (in(vd.buf, vd.len) && !memcmp(vd.buf, b.buf, b.len))));
+
+			auto cut = rnd() % d.len;
+			yy::Data_r tr(d.buf, cut);
+			YY_CHECK(om.ReadFrom(tr, v));
+		}
+		return 0;
+	}
+
+	// ComputeSize 与 WriteTo 实际写入的字节数 一致( 共享图 去重, 派生类, 变长整数, 各种容器 ). WriteToExact 写出的字节 与 WriteTo 相同
+	template<typename T>
+	int CheckComputeSize(std::mt19937_64& rnd, yy::object_handler& om, T const& v) {
+		yy::Data ref;
+		om.WriteTo(ref, v);
+		YY_CHECK(om.ComputeSize(v) == ref.len);
+		yy::Data d;
+		for (auto n = rnd() % 20; n; --n) {
+			d.WriteFixed((uint8_t)rnd());
+		}
+		auto prefix = d.len;
+		om.WriteToExact(d, v);
+		YY_CHECK(d.len - prefix == ref.len && !memcmp(d.buf + prefix, ref.buf, ref.len));
+		return 0;
+	}
+
+	enum class Color : int16_t { Red = -1, Green = 300 };
+
+	inline int TestComputeSize(std::mt19937_64& rnd, yy::object_handler& om) {
+		for (int round = 0; round < 50; ++round) {
+			auto g = MakeGraph(rnd, rnd() % 100);
+			if (int r = CheckComputeSize(rnd, om, g)) return r;
+			for (auto& o : g) {
+				if (o) {
+					if (int r = CheckComputeSize(rnd, om, o)) return r;
+					break;
+				}
+			}
+
+			std::optional<std::string> os;
+			if (rnd() % 2) {
+				os.emplace(rnd() % 200, 's');
+			}
+			std::map<int64_t, std::string> m;
+			std::set<uint32_t> st;
+			std::vector<double> ds;
+			std::vector<uint8_t> bs;
+			for (auto n = rnd() % 50; n; --n) {
+				m[(int64_t)rnd()] = std::string(rnd() % 5, 'm');
+				st.insert((uint32_t)(rnd() >> (rnd() % 32)));
+				ds.push_back((double)rnd());
+				bs.push_back((uint8_t)rnd());
+			}
+			auto t = std::make_tuple(os, m, st, ds, bs, rnd() % 2 ? Color::Red : Color::Green
+				, std::make_pair((int32_t)rnd(), (float)rnd()), (int8_t)rnd(), g.size() ? g[0] : yy::shared_ptr<Node>());
+			if (int r = CheckComputeSize(rnd, om, t)) return r;
+		}
+		return 0;
+	}
+
+	// IsRawLayout 结构体 整块 memcpy: 单个 及 vector 的 字节 为 内存映像( vector 前加 个数 ), DataFuncs 与 object_handler 一致 且 能 读回
+	// YY_FIELDS 合并 相邻成员 的 读写 与 逐个成员 读写 的 字节 相同
+	inline int TestRawLayout(std::mt19937_64& rnd, yy::object_handler& om) {
+		auto randVec3 = [&] {
+			return Vec3{ (float)rnd(), (float)rnd(), (float)rnd(), (int32_t)rnd() };
+		};
+		for (int round = 0; round < 100; ++round) {
+			std::vector<Vec3> vs(rnd() % 50);
+			for (auto& o : vs) {
+				o = randVec3();
+			}
+			yy::Data ref;
+			ref.WriteVarInteger(vs.size());
+			if (vs.size()) {
+				ref.WriteBuf(vs.data(), vs.size() * sizeof(Vec3));
+			}
+
+			yy::Data d;
+			d.Write(vs);
+			YY_CHECK(d == ref);
+			std::vector<Vec3> vs2;
+			yy::Data_r dr(d);
+			YY_CHECK(!dr.Read(vs2) && vs2 == vs && dr.offset == d.len);
+			d.Clear();
+			om.WriteTo(d, vs);
+			YY_CHECK(d == ref);
+			vs2.clear();
+			dr.Reset(d.buf, d.len);
+			YY_CHECK(!om.ReadFrom(dr, vs2) && vs2 == vs && dr.offset == d.len);
+			if (vs.size()) {
+				dr.Reset(d.buf, d.len - 1);
+				YY_CHECK(om.ReadFrom(dr, vs2));
+			}
+
+			auto v = randVec3();
+			d.Clear();
+			om.WriteTo(d, v);
+			YY_CHECK(d.len == sizeof(Vec3) && !memcmp(d.buf, &v, sizeof(Vec3)));
+			Vec3 v2{};
+			dr.Reset(d.buf, d.len);
+			YY_CHECK(!om.ReadFrom(dr, v2) && v2 == v);
+
+			Particle p;
+			p.x = (float)rnd();
+			p.y = (float)rnd();
+			p.v = v;
+			p.tag = (uint8_t)rnd();
+			p.w = (double)rnd();
+			p.id = (int32_t)rnd();
+			p.name.assign(rnd() % 10, 'p');
+			ref.Clear();
+			om.WriteTo(ref, std::make_tuple(p.x, p.y, p.v, p.tag, p.w, p.id, p.name));
+			d.Clear();
+			om.WriteTo(d, p);
+			YY_CHECK(d == ref);
+			Particle p2;
+			dr.Reset(d.buf, d.len);
+			YY_CHECK(!om.ReadFrom(dr, p2) && dr.offset == d.len);
+			YY_CHECK(p2.x == p.x && p2.y == p.y && p2.v == p.v && p2.tag == p.tag && p2.w == p.w && p2.id == p.id && p2.name == p.name);
+		}
+		return 0;
+	}
+
+	// scratch_vector: 不超过 N 个 不分配内存, clear 保留 容量 与 堆空间, peak 记 历史最大个数, Trim 退回 内置空间
+	// object_handler 各临时表: 处理过 大图 后 GetPeaks 报告 历史最大值, 再处理 小图 不重新分配, Trim 后 归 0 并 退回 内置空间
+	inline int TestScratchPeaks(std::mt19937_64& rnd) {
+		{
+			yy::scratch_vector<uint64_t, 8> sv;
+			auto inl = sv.data();
+			for (uint64_t i = 0; i < 8; ++i) {
+				sv.push_back(i);
+			}
+			YY_CHECK(sv.data() == inl && sv.capacity() == 8 && sv.peak == 0);
+			sv.push_back(8);
+			auto heap = sv.data();
+			YY_CHECK(heap != inl && sv.capacity() == 16 && sv.size() == 9);
+			for (uint64_t i = 0; i < 9; ++i) {
+				YY_CHECK(sv[i] == i);
+			}
+			sv.clear();
+			YY_CHECK(sv.empty() && sv.peak == 9 && sv.data() == heap && sv.capacity() == 16);
+			sv.resize(12);
+			sv.resize(3);
+			YY_CHECK(sv.size() == 3 && sv.peak == 12 && sv.data() == heap);
+			auto sv2 = sv;
+			YY_CHECK(sv2.size() == 3 && sv2.data() != sv.data() && sv2.capacity() == 8);
+			sv.Trim();
+			YY_CHECK(sv.empty() && sv.peak == 0 && sv.data() == inl && sv.capacity() == 8);
+		}
+
+		for (int side = 0; side < 2; ++side) {
+			yy::object_handler om;
+			om.sideTable = side;
+			auto p = om.GetPeaks();
+			YY_CHECK(!p.ptrs && !p.ptrs2 && !p.weaks && !p.sideIdxs && !p.scratch);
+
+			auto big = MakeGraph(rnd, 1000);
+			yy::Data d;
+			om.WriteTo(d, big);
+			Graph g2;
+			yy::Data_r dr(d);
+			YY_CHECK(!om.ReadFrom(dr, g2));
+			KeepAlive(om.Clone(big).size());
+			KeepAlive(om.ComputeSize(yy::EncodedVector<uint32_t, yy::IntEncodings::ForBitPack>(300, 7)));
+			p = om.GetPeaks();
+			if (side) {
+				YY_CHECK(p.sideIdxs >= 1000);
+			}
+			else {
+				YY_CHECK(p.ptrs >= 1000);
+			}
+			YY_CHECK(p.ptrs2 >= 1000 && p.weaks && p.scratch);
+			auto cap = om.ptrs.capacity(), cap2 = om.ptrs2.capacity();
+
+			// 小图: 历史最大值 不变, 不重新分配
+			auto small = MakeGraph(rnd, 10);
+			for (int i = 0; i < 10; ++i) {
+				d.Clear();
+				om.WriteTo(d, small);
+				g2.clear();
+				dr.Reset(d.buf, d.len);
+				YY_CHECK(!om.ReadFrom(dr, g2));
+			}
+			auto p2 = om.GetPeaks();
+			YY_CHECK(p2.ptrs == p.ptrs && p2.ptrs2 == p.ptrs2 && p2.sideIdxs == p.sideIdxs && p2.scratch == p.scratch);
+			YY_CHECK(om.ptrs.capacity() == cap && om.ptrs2.capacity() == cap2);
+
+			om.Trim();
+			p = om.GetPeaks();
+			YY_CHECK(!p.ptrs && !p.ptrs2 && !p.weaks && !p.sideIdxs && !p.scratch);
+			YY_CHECK(om.ptrs.capacity() == 32 && om.ptrs2.capacity() == 16 && om.weaks.capacity() == 8);
+
+			// Trim 后 照常使用
+			d.Clear();
+			om.WriteTo(d, small);
+			g2.clear();
+			dr.Reset(d.buf, d.len);
+			YY_CHECK(!om.ReadFrom(dr, g2) && g2.size() == small.size());
+		}
+		return 0;
+	}
+
+	inline int TestObject() {
+		yy::object_handler::Register<Node>();
+		yy::object_handler::Register<BigNode>();
+		yy::object_handler::Register<Particle>();
+		std::mt19937_64 rnd(1);
+		yy::object_handler om;
+		if (int r = TestSharedGraphArena(rnd, om)) return r;
+		if (int r = TestSharedGraphClone(rnd, om)) return r;
+		if (int r = TestSetDefaultValue(om)) return r;
+		if (int r = TestBorrowedViews(rnd, om)) return r;
+		if (int r = TestComputeSize(rnd, om)) return r;
+		if (int r = TestRawLayout(rnd, om)) return r;
+		if (int r = TestScratchPeaks(rnd)) return r;
+		return 0;
+	}
+}
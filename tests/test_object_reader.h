@@ -0,0 +1,66 @@
+﻿#pragma once
+#include "helpers.h"
+
+namespace yy_tests {
+
+	// 按 随机长度( 1 ~ maxChunk 字节 ) 分段 Feed, 结果 须与 原值 相同
+	template<typename T>
+	int FeedInChunks(std::mt19937_64& rnd, yy::object_handler& om, yy::Data const& d, T const& ref, bool const& knownTotal, size_t const& maxChunk) {
+		T v;
+		yy::object_reader<T> rd(om, v, knownTotal ? d.len : 0);
+		size_t pos = 0;
+		int r = -1;
+		while (r == -1) {
+			YY_CHECK(pos < d.len);
+			auto n = std::min(d.len - pos, 1 + (size_t)(rnd() % maxChunk));
+			r = rd.Feed(d.buf + pos, n);
+			pos += n;
+		}
+		YY_CHECK(r == 0 && pos == d.len);
+		YY_CHECK(v == ref);
+		return 0;
+	}
+
+	// object_reader: 小元素 与 大元素( 跨 上千段 ) 混合. 已知总长 时 大元素 不应 每段 都 从头 重解( 否则 此处 要 多解 约 1GB )
+	inline int TestObjectReader() {
+		std::mt19937_64 rnd(1);
+		yy::object_handler om;
+		using T = std::vector<std::vector<uint32_t>>;
+		for (int round = 0; round < 20; ++round) {
+			T vs(rnd() % 50);
+			for (auto& v : vs) {
+				v.resize(rnd() % 30);
+				for (auto& i : v) {
+					i = (uint32_t)rnd() >> (rnd() % 32);
+				}
+			}
+			yy::Data d;
+			om.WriteTo(d, vs);
+			if (int r = FeedInChunks(rnd, om, d, vs, true, 16)) return r;
+			if (int r = FeedInChunks(rnd, om, d, vs, false, 16)) return r;
+
+			if (round % 5) continue;
+			vs.emplace_back(200000);
+			for (auto& i : vs.back()) {
+				i = (uint32_t)rnd() >> 12;
+			}
+			vs.emplace_back(3, round);
+			d.Clear();
+			om.WriteTo(d, vs);
+			if (int r = FeedInChunks(rnd, om, d, vs, true, 256)) return r;
+		}
+
+		// 出错: 总长 比 实际数据 短, 收齐后 仍解不完
+		T vs{ { 1, 2, 3 }, { 4, 5, 6 } };
+		yy::Data d;
+		om.WriteTo(d, vs);
+		T v;
+		yy::object_reader<T> rd(om, v, d.len - 1);
+		int r = -1;
+		for (size_t i = 0; i + 1 < d.len && r == -1; ++i) {
+			r = rd.Feed(d.buf + i, 1);
+		}
+		YY_CHECK(r != 0 && r != -1);
+		return 0;
+	}
+}
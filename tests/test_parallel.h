@@ -0,0 +1,55 @@
+﻿#pragma once
+#include "test_object.h"
+#include <yy_object_parallel.h>
+
+namespace yy_tests {
+
+	// 各元素 只引用 自己私有的 节点( 块间 无共享, 并行写入 只需 平移序号 )
+	inline Graph MakePrivateGraph(std::mt19937_64& rnd, size_t const& n) {
+		Graph g(n);
+		for (auto& o : g) {
+			o = yy::Make<Node>();
+			o->name.assign(rnd() % 10, 'p');
+			if (rnd() % 4) {
+				o->next = yy::Make<BigNode>();
+				o->next->parent = o;
+				o->next->kids.push_back(yy::Make<Node>());
+				o->next->kids[0]->parent = o->next;
+			}
+		}
+		return g;
+	}
+
+	// 各种 线程数 / 块数 下 与 object_handler::WriteTo 逐字节相同, 且 写完后 认领 已清除( 顺序写 结果不变 ). pw 跨图 复用
+	inline int CheckParallelWrite(yy::object_handler& om, yy::object_parallel_writer& pw, Graph const& g) {
+		yy::Data d0;
+		om.WriteTo(d0, g);
+		for (size_t t : { 1, 2, 3, 8 }) {
+			for (size_t c : { 0, 1, 2, 5, 64 }) {
+				pw.numThreads = t;
+				pw.numChunks = c;
+				yy::Data d;
+				d.WriteFixed((uint8_t)9);
+				pw.WriteTo(d, g);
+				YY_CHECK(d.len == d0.len + 1 && !memcmp(d.buf + 1, d0.buf, d0.len));
+			}
+		}
+		yy::Data d1;
+		om.WriteTo(d1, g);
+		YY_CHECK(d1 == d0);
+		return 0;
+	}
+
+	inline int TestParallelWrite() {
+		std::mt19937_64 rnd(1);
+		yy::object_handler om;
+		yy::object_parallel_writer pw;
+		for (int round = 0; round < 50; ++round) {
+			auto g = MakeGraph(rnd, rnd() % 200);
+			if (int r = CheckParallelWrite(om, pw, g)) return r;
+			g = MakePrivateGraph(rnd, rnd() % 500);				// 序号 超过 127, 平移后 变长编码 变长
+			if (int r = CheckParallelWrite(om, pw, g)) return r;
+		}
+		return 0;
+	}
+}
@@ -0,0 +1,183 @@
+﻿#pragma once
+#include "helpers.h"
+
+namespace yy_tests {
+
+	// 随机 位宽 的 整数( 使 各种 变长长度 都常见 )
+	template<typename T>
+	T RandomInteger(std::mt19937_64& rnd) {
+		using U = std::make_unsigned_t<T>;
+		auto bits = rnd() % (sizeof(T) * 8 + 1);
+		return (T)(U)(bits ? rnd() >> (64 - bits) : 0);
+	}
+
+	// 解码 d 中的 n 个值: 批量 ReadVarIntegers 与 逐个 ReadVarInteger 的 成败, 结果, offset 须一致
+	// d 的内存 须 恰好为 数据长度( 堆上 分配 ), 以便 ASan 发现 越界读
+	template<typename T>
+	int CheckReadVarIntegers(yy::Data_r const& d, size_t const& n) {
+		std::vector<T> a(n), b(n);
+		yy::Data_r da(d), db(d);
+		auto ra = da.ReadVarIntegers(a.data(), n);
+		int rb = 0;
+		for (size_t i = 0; i < n && !rb; ++i) {
+			rb = db.ReadVarInteger(b[i]);
+		}
+		YY_CHECK(!ra == !rb);
+		if (!ra) {
+			YY_CHECK(a == b);
+			YY_CHECK(da.offset == db.offset);
+		}
+		return 0;
+	}
+
+	// ReadVarIntegers 随机测试: 合法编码( 随机长度, 随机位宽 ) 及 随机字节( 多为 非法 / 截断 )
+	template<typename T>
+	int TestReadVarIntegers(std::mt19937_64& rnd) {
+		for (int round = 0; round < 2000; ++round) {
+			auto n = (size_t)(rnd() % 100);
+			std::vector<T> vs(n);
+			for (auto& v : vs) {
+				v = RandomInteger<T>(rnd);
+			}
+			yy::Data d;
+			d.WriteVarIntegers(vs.data(), n);
+			{
+				std::vector<uint8_t> exact(d.buf, d.buf + d.len);
+				std::vector<T> out(n);
+				yy::Data_r dr(exact.data(), exact.size());
+				YY_CHECK(!dr.ReadVarIntegers(out.data(), n));
+				YY_CHECK(out == vs && dr.offset == exact.size());
+				if (int r = CheckReadVarIntegers<T>(yy::Data_r(exact.data(), exact.size()), n)) return r;
+			}
+			if (n) {
+				// 截断
+				auto cut = (size_t)(rnd() % d.len);
+				std::vector<uint8_t> exact(d.buf, d.buf + cut);
+				if (int r = CheckReadVarIntegers<T>(yy::Data_r(exact.data(), exact.size()), n)) return r;
+			}
+			{
+				auto siz = (size_t)(rnd() % 200);
+				std::vector<uint8_t> junk(siz);
+				for (auto& c : junk) {
+					c = (uint8_t)(rnd() % 4 ? rnd() | 0x80 : rnd());	// 延续位 多半为 1
+				}
+				if (int r = CheckReadVarIntegers<T>(yy::Data_r(junk.data(), junk.size()), rnd() % 40)) return r;
+			}
+		}
+		return 0;
+	}
+
+	// ReadVarInteger 随机测试: 余量 >= 8 字节 的 快速路径 与 逐字节路径( 余量 < 8 ) 的 成败, 结果, offset 须一致
+	template<typename T>
+	int TestReadVarInteger(std::mt19937_64& rnd) {
+		for (int round = 0; round < 100000; ++round) {
+			uint8_t b[16];
+			auto n = 1 + rnd() % 10;									// 终止字节 的 位置
+			for (size_t i = 0; i < 16; ++i) {
+				b[i] = (uint8_t)(rnd() | (i + 1 < n ? 0x80 : 0));
+			}
+			T a{}, c{};
+			yy::Data_r fast(b, 16), loop(b, 7);
+			auto ra = fast.ReadVarInteger(a);
+			if (ra || fast.offset > 7) continue;						// 超过 7 字节 的 值 两边 都走 逐字节
+			YY_CHECK(!loop.ReadVarInteger(c));
+			YY_CHECK(a == c && fast.offset == loop.offset);
+		}
+		for (int round = 0; round < 100000; ++round) {
+			uint8_t b[16];
+			for (auto& c : b) {
+				c = (uint8_t)rnd();
+			}
+			T a{}, c{};
+			yy::Data_r fast(b, 16), loop(b, 7);
+			if (fast.ReadVarInteger(a)) {
+				YY_CHECK(loop.ReadVarInteger(c));
+			}
+		}
+		return 0;
+	}
+
+	// BSwapArray 及 WriteFixedArrayBE / ReadFixedArrayBE 随机测试: 与 逐个 BSwap / WriteFixedBE / ReadFixedBE 的 结果 逐字节 一致
+	// 个数 覆盖 0, 不足 16 字节, 整 16 字节 及 其 + 奇数尾部. 源 与 目标 地址 随机 不对齐, 另测 原地 交换
+	template<typename T>
+	int TestFixedArrayBE(std::mt19937_64& rnd) {
+		constexpr size_t S = sizeof(T);
+		for (int round = 0; round < 2000; ++round) {
+			auto n = (size_t)(rnd() % (round % 10 ? 40 : 300));
+			auto ia = (size_t)(rnd() % 16), ib = (size_t)(rnd() % 16);
+			std::vector<uint8_t> src(ia + n * S + 1), dst(ib + n * S + 1), ref(n * S);		// +1: n 为 0 时 指针 也非空( 读写 会 assert )
+			for (auto& c : src) {
+				c = (uint8_t)rnd();
+			}
+			for (size_t i = 0; i < n; ++i) {
+				T v;
+				memcpy(&v, &src[ia + i * S], S);
+				v = yy::BSwap(v);
+				memcpy(&ref[i * S], &v, S);
+				for (size_t j = 0; j < S; ++j) {
+					YY_CHECK(ref[i * S + j] == src[ia + i * S + S - 1 - j]);
+				}
+			}
+			yy::BSwapArray<T>(src.data() + ia, dst.data() + ib, n);
+			YY_CHECK(!n || !memcmp(dst.data() + ib, ref.data(), n * S));
+			auto inplace = src;
+			yy::BSwapArray<T>(inplace.data() + ia, inplace.data() + ia, n);
+			YY_CHECK(!n || !memcmp(inplace.data() + ia, ref.data(), n * S));
+
+			// 写: 源 为 不对齐的 T*. 已有数据 使 写入位置 也不对齐
+			yy::Data d, d2;
+			for (auto k = rnd() % 16; k; --k) {
+				auto c = (uint8_t)rnd();
+				d.WriteFixed(c);
+				d2.WriteFixed(c);
+			}
+			auto prefix = d.len;
+			d.WriteFixedArrayBE((T const*)(src.data() + ia), n);
+			for (size_t i = 0; i < n; ++i) {
+				T v;
+				memcpy(&v, &src[ia + i * S], S);
+				d2.WriteFixedBE(v);
+			}
+			YY_CHECK(d.len == prefix + n * S && d == d2);
+
+			// 读: 目标 为 不对齐的 T*
+			yy::Data_r dr(d.buf, d.len, prefix), dr2(d.buf, d.len, prefix);
+			YY_CHECK(!dr.ReadFixedArrayBE((T*)(dst.data() + ib), n) && dr.offset == d.len);
+			for (size_t i = 0; i < n; ++i) {
+				T v;
+				YY_CHECK(!dr2.ReadFixedBE(v));
+				YY_CHECK(!memcmp(&dst[ib + i * S], &v, S) && !memcmp(&v, &src[ia + i * S], S));
+			}
+			if (n) {
+				yy::Data_r tr(d.buf, d.len - 1, prefix);
+				YY_CHECK(tr.ReadFixedArrayBE((T*)(dst.data() + ib), n) && tr.offset == prefix);
+			}
+		}
+		return 0;
+	}
+
+	inline int TestVarInt() {
+		std::mt19937_64 rnd(12345);
+		if (int r = TestReadVarInteger<uint8_t>(rnd)) return r;
+		if (int r = TestReadVarInteger<int8_t>(rnd)) return r;
+		if (int r = TestReadVarInteger<uint16_t>(rnd)) return r;
+		if (int r = TestReadVarInteger<int16_t>(rnd)) return r;
+		if (int r = TestReadVarInteger<uint32_t>(rnd)) return r;
+		if (int r = TestReadVarInteger<int32_t>(rnd)) return r;
+		if (int r = TestReadVarInteger<uint64_t>(rnd)) return r;
+		if (int r = TestReadVarInteger<int64_t>(rnd)) return r;
+		if (int r = TestReadVarIntegers<uint16_t>(rnd)) return r;
+		if (int r = TestReadVarIntegers<int16_t>(rnd)) return r;
+		if (int r = TestReadVarIntegers<uint32_t>(rnd)) return r;
+		if (int r = TestReadVarIntegers<int32_t>(rnd)) return r;
+		if (int r = TestReadVarIntegers<uint64_t>(rnd)) return r;
+		if (int r = TestReadVarIntegers<int64_t>(rnd)) return r;
+		if (int r = TestFixedArrayBE<uint16_t>(rnd)) return r;
+		if (int r = TestFixedArrayBE<int16_t>(rnd)) return r;
+		if (int r = TestFixedArrayBE<uint32_t>(rnd)) return r;
+		if (int r = TestFixedArrayBE<float>(rnd)) return r;
+		if (int r = TestFixedArrayBE<uint64_t>(rnd)) return r;
+		if (int r = TestFixedArrayBE<double>(rnd)) return r;
+		return 0;
+	}
+}